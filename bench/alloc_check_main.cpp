@@ -0,0 +1,325 @@
+#include <vkw/warning_suppressor.h>
+
+BEGIN_VKW_SUPPRESS_WARNING
+#include <imgui.h>
+#include <imgui_impl_vulkanhpp.h>
+END_VKW_SUPPRESS_WARNING
+
+#include <vkw/vkw.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "bench_utils.h"
+#include "offscreen.h"
+
+// -----------------------------------------------------------------------------
+// ----------------------------- Counting Allocator ----------------------------
+// -----------------------------------------------------------------------------
+// Every `operator new` of the process is counted, including the ones in the
+// backend, vkw and vulkan.hpp. All replaceable forms are replaced (Array,
+// nothrow and aligned ones), so that none of them bypasses the count.
+// (C allocations inside drivers are not counted)
+namespace {
+std::atomic<uint64_t> g_n_allocs(0);
+
+void* CountedAlloc(size_t n_bytes) noexcept {
+    g_n_allocs.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(n_bytes ? n_bytes : 1);
+}
+
+void* CountedAllocOrThrow(size_t n_bytes) {
+    void* p = CountedAlloc(n_bytes);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+}  // anonymous namespace
+
+void* operator new(size_t n_bytes) {
+    return CountedAllocOrThrow(n_bytes);
+}
+
+void* operator new[](size_t n_bytes) {
+    return CountedAllocOrThrow(n_bytes);
+}
+
+void* operator new(size_t n_bytes, const std::nothrow_t&) noexcept {
+    return CountedAlloc(n_bytes);
+}
+
+void* operator new[](size_t n_bytes, const std::nothrow_t&) noexcept {
+    return CountedAlloc(n_bytes);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+#if defined(__cpp_aligned_new)
+// Over-aligned types (C++17 and later)
+namespace {
+void* CountedAlignedAlloc(size_t n_bytes, std::align_val_t align) noexcept {
+    g_n_allocs.fetch_add(1, std::memory_order_relaxed);
+    // Size must be a multiple of the alignment
+    const size_t n_align = static_cast<size_t>(align);
+    const size_t n_padded =
+            (std::max<size_t>(n_bytes, 1) + n_align - 1) / n_align * n_align;
+    return std::aligned_alloc(n_align, n_padded);
+}
+
+void* CountedAlignedAllocOrThrow(size_t n_bytes, std::align_val_t align) {
+    void* p = CountedAlignedAlloc(n_bytes, align);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+}  // anonymous namespace
+
+void* operator new(size_t n_bytes, std::align_val_t align) {
+    return CountedAlignedAllocOrThrow(n_bytes, align);
+}
+
+void* operator new[](size_t n_bytes, std::align_val_t align) {
+    return CountedAlignedAllocOrThrow(n_bytes, align);
+}
+
+void* operator new(size_t n_bytes, std::align_val_t align,
+                   const std::nothrow_t&) noexcept {
+    return CountedAlignedAlloc(n_bytes, align);
+}
+
+void* operator new[](size_t n_bytes, std::align_val_t align,
+                     const std::nothrow_t&) noexcept {
+    return CountedAlignedAlloc(n_bytes, align);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+#endif
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// ----------------------------------- Runner ----------------------------------
+// -----------------------------------------------------------------------------
+struct Args {
+    int n_warmup = 30;
+    int n_frames = 100;
+    vk::Extent2D size = {1280, 720};
+    bool debug = false;
+};
+
+// Backend options to check (Each steady state must be allocation-free)
+struct Config {
+    std::string name;
+    ImGui_ImplVulkanHpp_Options options;
+    bool has_bg = false;
+};
+
+void PrintUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]" << std::endl
+              << "  --frames N        checked frames (default: 100)"
+              << std::endl
+              << "  --warmup N        unchecked frames (default: 30)"
+              << std::endl
+              << "  --size WxH        target size (default: 1280x720)"
+              << std::endl
+              << "  --debug           enable validation layers" << std::endl;
+}
+
+bool ParseArgs(int argc, char const* argv[], Args& args) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_val = (i + 1 < argc);
+        if (arg == "--frames" && has_val) {
+            args.n_frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--warmup" && has_val) {
+            args.n_warmup = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--size" && has_val) {
+            unsigned w = 0, h = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &w, &h) != 2 || !w || !h) {
+                return false;
+            }
+            args.size = vk::Extent2D{w, h};
+        } else if (arg == "--debug") {
+            args.debug = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<Config> MakeConfigs() {
+    ImGui_ImplVulkanHpp_Options base;
+    base.gpu_timing = true;
+    base.async_pipeline_build = false;  // Ready before the check begins
+
+    std::vector<Config> configs;
+    configs.push_back({"default", base, false});
+    configs.push_back({"compact", base, false});
+    configs.back().options.vertex_format =
+            ImGui_ImplVulkanHpp_VertexFormat::Compact;
+    configs.push_back({"vertex_pulling", base, false});
+    configs.back().options.vertex_pulling = true;
+    configs.push_back({"instanced_quads", base, false});
+    configs.back().options.instanced_quads = true;
+    configs.push_back({"overlay_scale", base, false});
+    configs.back().options.overlay_scale = 0.5f;
+    configs.push_back({"bg_shader", base, true});
+    configs.back().options.bg_composite =
+            ImGui_ImplVulkanHpp_BgComposite::Shader;
+    configs.push_back({"bg_transfer", base, true});
+    configs.back().options.bg_composite =
+            ImGui_ImplVulkanHpp_BgComposite::Auto;
+    return configs;
+}
+
+// Returns the largest number of allocations in one checked frame
+uint64_t RunConfig(const OffscreenEnv& env, const Config& config,
+                   const vkw::ImagePackPtr& bg_img_pack, const Args& args,
+                   uint64_t& dst_total) {
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = {static_cast<float>(args.size.width),
+                      static_cast<float>(args.size.height)};
+    io.DeltaTime = 1.f / 60.f;
+    ImGui_ImplVulkanHpp_SetOptions(config.options);
+
+    auto& cmd_buf = env.cmd_bufs_pack->cmd_bufs[0];
+    uint64_t max_allocs = 0;
+    dst_total = 0;
+    for (int i = 0; i < args.n_warmup + args.n_frames; i++) {
+        // Only the backend calls are counted (Not ImGui's own frame)
+        uint64_t n_begin = g_n_allocs.load(std::memory_order_relaxed);
+        ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+        uint64_t n_allocs =
+                g_n_allocs.load(std::memory_order_relaxed) - n_begin;
+        ImGui::NewFrame();
+        DrawTestFrame("Allocation Check", i, {400.f, 200.f});
+        ImGui::Render();
+        ImDrawData* draw_data = ImGui::GetDrawData();
+
+        n_begin = g_n_allocs.load(std::memory_order_relaxed);
+        vk::ImageView bg_img_view;
+        if (config.has_bg) {
+            ImGui_ImplVulkanHpp_BgImages bg_imgs;
+            bg_imgs.bg_img = bg_img_pack->img.get();
+            bg_imgs.bg_img_format = env.dst_img_format;
+            bg_imgs.bg_img_size = env.dst_img_size;
+            bg_imgs.dst_img = env.dst_img_pack->img.get();
+            ImGui_ImplVulkanHpp_SetBgImages(bg_imgs);
+            bg_img_view = bg_img_pack->view.get();
+        }
+
+        ImGui_ImplVulkanHpp_RenderDrawData(
+                draw_data, cmd_buf, env.dst_img_pack->view.get(),
+                env.dst_img_format, env.dst_img_size,
+                vk::ImageLayout::eTransferSrcOptimal, bg_img_view,
+                vk::ImageLayout::eShaderReadOnlyOptimal);
+        n_allocs += g_n_allocs.load(std::memory_order_relaxed) - n_begin;
+        SubmitAndWait(env);
+
+        if (args.n_warmup <= i) {
+            max_allocs = std::max(max_allocs, n_allocs);
+            dst_total += n_allocs;
+        }
+    }
+    return max_allocs;
+}
+
+}  // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    Args args;
+    if (!ParseArgs(argc, argv, args)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    auto env = CreateOffscreenEnv("ImGui-VulkanHpp Allocation Check",
+                                  args.size, args.debug);
+    const vkw::ImagePackPtr bg_img_pack = CreateBgImage(env);
+    std::printf("Device: %s\n", GetDeviceName(env).c_str());
+    std::printf("  %-20s %12s %12s\n", "config", "allocs", "max/frame");
+
+    bool is_passed = true;
+    for (auto&& config : MakeConfigs()) {
+        // Fresh context for each configuration
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGui::GetIO().IniFilename = nullptr;
+        ImGui_ImplVulkanHpp_Init();
+
+        uint64_t total = 0;
+        const uint64_t max_allocs =
+                RunConfig(env, config, bg_img_pack, args, total);
+        std::printf("  %-20s %12llu %12llu%s\n", config.name.c_str(),
+                    static_cast<unsigned long long>(total),
+                    static_cast<unsigned long long>(max_allocs),
+                    max_allocs ? "  FAILED" : "");
+        is_passed &= (max_allocs == 0);
+
+        env.device->waitIdle();
+        ImGui_ImplVulkanHpp_Shutdown();
+        ImGui::DestroyContext();
+    }
+
+    std::printf("%s\n", is_passed ? "Passed: no heap allocation per frame" :
+                                    "Failed: heap allocation per frame");
+    return is_passed ? 0 : 1;
+}
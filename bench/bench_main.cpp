@@ -0,0 +1,757 @@
+#include <vkw/warning_suppressor.h>
+
+BEGIN_VKW_SUPPRESS_WARNING
+#include <imgui.h>
+#include <imgui_impl_vulkanhpp.h>
+#include <imgui_impl_vulkanhpp_capture.h>
+END_VKW_SUPPRESS_WARNING
+
+#include <vkw/vkw.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench_utils.h"
+#include "offscreen.h"
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// ----------------------------- Synthetic Workloads ---------------------------
+// -----------------------------------------------------------------------------
+using Scenario = std::function<void(int)>;
+
+void DrawDemo(int frame_idx) {
+    (void)frame_idx;
+    ImGui::SetNextWindowPos({0.f, 0.f}, ImGuiCond_Always);
+    ImGui::SetNextWindowSize({800.f, 1000.f}, ImGuiCond_Always);
+    ImGui::ShowDemoWindow();
+    ImGui::SetNextWindowPos({820.f, 0.f}, ImGuiCond_Always);
+    ImGui::SetNextWindowSize({600.f, 1000.f}, ImGuiCond_Always);
+    ImGui::ShowMetricsWindow();
+}
+
+void DrawLargeTable(int frame_idx) {
+    const int N_COLS = 8;
+    const int N_ROWS = 400;
+    const ImVec2& display_size = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos({0.f, 0.f}, ImGuiCond_Always);
+    ImGui::SetNextWindowSize(display_size, ImGuiCond_Always);
+    ImGui::Begin("Large Table");
+    const ImGuiTableFlags flags = ImGuiTableFlags_Borders |
+                                  ImGuiTableFlags_RowBg |
+                                  ImGuiTableFlags_Resizable;
+    if (ImGui::BeginTable("table", N_COLS, flags)) {
+        for (int row = 0; row < N_ROWS; row++) {
+            ImGui::TableNextRow();
+            for (int col = 0; col < N_COLS; col++) {
+                ImGui::TableSetColumnIndex(col);
+                ImGui::Text("R%03d C%d %08d", row, col,
+                            (row * 7919 + col * 104729 + frame_idx) % 99991);
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+void DrawDenseText(int frame_idx) {
+    const int N_LINES = 200;
+    const ImVec2& display_size = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos({0.f, 0.f}, ImGuiCond_Always);
+    ImGui::SetNextWindowSize(display_size, ImGuiCond_Always);
+    ImGui::Begin("Dense Text");
+    for (int i = 0; i < N_LINES; i++) {
+        ImGui::Text("%04d The quick brown fox jumps over the lazy dog. "
+                    "0123456789 !\"#$%%&'()*+,-./:;<=>?@[\\]^_`{|}~ %d",
+                    i, frame_idx);
+    }
+    ImGui::End();
+}
+
+void DrawManyWindows(int frame_idx) {
+    const int N_WINDOWS = 64;
+    const int N_COLS = 8;
+    const ImVec2 WINDOW_SIZE = {220.f, 130.f};
+    for (int i = 0; i < N_WINDOWS; i++) {
+        const float x = static_cast<float>(i % N_COLS) * WINDOW_SIZE.x;
+        const float y = static_cast<float>(i / N_COLS) * WINDOW_SIZE.y;
+        ImGui::SetNextWindowPos({x, y}, ImGuiCond_Always);
+        ImGui::SetNextWindowSize(WINDOW_SIZE, ImGuiCond_Always);
+        const std::string title = "Window " + std::to_string(i);
+        ImGui::Begin(title.c_str());
+        float value = static_cast<float>((frame_idx + i) % 100) / 100.f;
+        ImGui::SliderFloat("Slider", &value, 0.f, 1.f);
+        ImGui::ProgressBar(value);
+        bool checked = (i % 2) == 0;
+        ImGui::Checkbox("Check", &checked);
+        ImGui::Button("Button");
+        ImGui::End();
+    }
+}
+
+// Long time series (CPU tessellation vs. GPU expansion)
+// (One polyline must fit in 16-bit indices, up to 4 vertices per point)
+constexpr uint32_t N_PLOT_SAMPLES = 12000;
+
+struct PlotData {
+    std::vector<float> samples;
+    std::vector<ImVec2> points;  // Reused for CPU tessellation
+    vkw::BufferPackPtr buf_pack;
+};
+PlotData g_plot_data;
+
+void PreparePlotData(const OffscreenEnv& env) {
+    if (g_plot_data.buf_pack) {
+        return;
+    }
+    auto& samples = g_plot_data.samples;
+    samples.resize(N_PLOT_SAMPLES);
+    for (uint32_t i = 0; i < N_PLOT_SAMPLES; i++) {
+        const float t = static_cast<float>(i) * 0.001f;
+        samples[i] = std::sin(t) * 0.7f + std::sin(t * 37.f) * 0.2f;
+    }
+    const size_t n_bytes = samples.size() * sizeof(float);
+    g_plot_data.buf_pack = vkw::CreateBufferPack(
+            env.physical_device, env.device, n_bytes,
+            vk::BufferUsageFlagBits::eVertexBuffer,
+            vkw::HOST_VISIB_COHER_PROPS);
+    vkw::SendToDevice(env.device, g_plot_data.buf_pack, samples.data(),
+                      n_bytes);
+}
+
+ImVec4 BeginPlotWindow(const char* title) {
+    const ImVec2& display_size = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos({0.f, 0.f}, ImGuiCond_Always);
+    ImGui::SetNextWindowSize(display_size, ImGuiCond_Always);
+    ImGui::Begin(title);
+    const ImVec2 rect_min = ImGui::GetCursorScreenPos();
+    const ImVec2 avail = ImGui::GetContentRegionAvail();
+    return {rect_min.x, rect_min.y, rect_min.x + avail.x, rect_min.y + avail.y};
+}
+
+void DrawCpuPlot(int frame_idx) {
+    (void)frame_idx;
+    const ImVec4 rect = BeginPlotWindow("CPU Plot");
+    auto& points = g_plot_data.points;
+    const auto& samples = g_plot_data.samples;
+    points.resize(samples.size());
+    const float x_step =
+            (rect.z - rect.x) / static_cast<float>(N_PLOT_SAMPLES - 1);
+    const float y_mid = (rect.y + rect.w) * 0.5f;
+    const float y_scale = (rect.y - rect.w) * 0.5f;
+    for (uint32_t i = 0; i < N_PLOT_SAMPLES; i++) {
+        points[i] = {rect.x + x_step * static_cast<float>(i),
+                     y_mid + samples[i] * y_scale};
+    }
+    ImGui::GetWindowDrawList()->AddPolyline(
+            points.data(), static_cast<int>(points.size()),
+            IM_COL32(255, 200, 0, 255), ImDrawFlags_None, 1.f);
+    ImGui::End();
+}
+
+void DrawGpuPlot(int frame_idx) {
+    (void)frame_idx;
+    const ImVec4 rect = BeginPlotWindow("GPU Plot");
+    ImGui_ImplVulkanHpp_PlotDesc desc;
+    desc.samples_buf = g_plot_data.buf_pack->buf.get();
+    desc.n_samples = N_PLOT_SAMPLES;
+    desc.rect_min = {rect.x, rect.y};
+    desc.rect_max = {rect.z, rect.w};
+    desc.value_min = -1.f;
+    desc.value_max = 1.f;
+    desc.col = IM_COL32(255, 200, 0, 255);
+    ImGui_ImplVulkanHpp_AddPlot(ImGui::GetWindowDrawList(), desc);
+    ImGui::End();
+}
+
+// Many small icons packed into atlas pages (Registered at the first frame)
+constexpr int N_ICONS = 1024;
+constexpr uint32_t ICON_SIZE = 32;
+std::vector<ImTextureID> g_icon_ids;
+
+void RegisterIcons() {
+    g_icon_ids.clear();
+    std::vector<uint8_t> pixels(ICON_SIZE * ICON_SIZE * 4);
+    for (int i = 0; i < N_ICONS; i++) {
+        // Distinct pattern and color for each icon
+        for (uint32_t y = 0; y < ICON_SIZE; y++) {
+            for (uint32_t x = 0; x < ICON_SIZE; x++) {
+                uint8_t* p = &pixels[(y * ICON_SIZE + x) * 4];
+                const bool is_on =
+                        ((x / 4 + y / 4 + static_cast<uint32_t>(i)) % 3) != 0;
+                p[0] = static_cast<uint8_t>(i * 37);
+                p[1] = static_cast<uint8_t>(i * 91);
+                p[2] = static_cast<uint8_t>(i * 13);
+                p[3] = is_on ? 255 : 64;
+            }
+        }
+        g_icon_ids.push_back(ImGui_ImplVulkanHpp_AddAtlasTexture(
+                pixels.data(), ICON_SIZE, ICON_SIZE));
+    }
+}
+
+void DrawIcons(int frame_idx) {
+    const int N_COLS = 40;
+    if (frame_idx == 0) {
+        RegisterIcons();  // Backend is fresh for each scenario
+    }
+    const ImVec2& display_size = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos({0.f, 0.f}, ImGuiCond_Always);
+    ImGui::SetNextWindowSize(display_size, ImGuiCond_Always);
+    ImGui::Begin("Icons");
+    const float icon_size = static_cast<float>(ICON_SIZE);
+    for (int i = 0; i < N_ICONS; i++) {
+        if (i % N_COLS != 0) {
+            ImGui::SameLine();
+        }
+        ImGui::Image(g_icon_ids[static_cast<size_t>(i)],
+                     {icon_size, icon_size});
+    }
+    ImGui::End();
+}
+
+// Video streams updated every frame (Registered at the first frame)
+constexpr int N_STREAMS = 4;
+constexpr uint32_t STREAM_WIDTH = 640;
+constexpr uint32_t STREAM_HEIGHT = 360;
+std::vector<ImTextureID> g_stream_ids;
+
+// Moving color bars (Rows are written sequentially like a decoder)
+void WriteStreamFrame(const ImGui_ImplVulkanHpp_TextureUpdate& update,
+                      int stream_idx, int frame_idx) {
+    for (uint32_t y = 0; y < update.size.height; y++) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(update.pixels +
+                                                    update.row_bytes * y);
+        for (uint32_t x = 0; x < update.size.width; x++) {
+            const uint32_t bar = (x + static_cast<uint32_t>(frame_idx) * 4 +
+                                  static_cast<uint32_t>(stream_idx) * 80) /
+                                 80;
+            row[x] = IM_COL32((bar * 53) & 0xFF, (bar * 97) & 0xFF,
+                              (y * 255) / update.size.height, 255);
+        }
+    }
+}
+
+void DrawStreams(int frame_idx) {
+    if (frame_idx == 0) {
+        // Backend is fresh for each scenario
+        g_stream_ids.clear();
+        ImGui_ImplVulkanHpp_StreamingTexDesc desc;
+        desc.size = vk::Extent2D{STREAM_WIDTH, STREAM_HEIGHT};
+        for (int i = 0; i < N_STREAMS; i++) {
+            g_stream_ids.push_back(
+                    ImGui_ImplVulkanHpp_AddStreamingTexture(desc));
+        }
+    }
+    const ImVec2 size = {static_cast<float>(STREAM_WIDTH),
+                         static_cast<float>(STREAM_HEIGHT)};
+    for (int i = 0; i < N_STREAMS; i++) {
+        const ImTextureID tex_id = g_stream_ids[static_cast<size_t>(i)];
+        ImGui_ImplVulkanHpp_TextureUpdate update;
+        if (ImGui_ImplVulkanHpp_AcquireTextureUpdate(tex_id, update)) {
+            WriteStreamFrame(update, i, frame_idx);
+        }
+        const std::string title = "Stream " + std::to_string(i);
+        ImGui::SetNextWindowPos({static_cast<float>(i % 2) * (size.x + 20.f),
+                                 static_cast<float>(i / 2) * (size.y + 40.f)},
+                                ImGuiCond_Always);
+        ImGui::Begin(title.c_str(), nullptr,
+                     ImGuiWindowFlags_AlwaysAutoResize);
+        ImGui::Image(tex_id, size);
+        ImGui::End();
+    }
+}
+
+// Million-vertex mesh in one draw list (e.g. node editors and dense plots)
+// (Over 64K vertices, needs `RendererHasVtxOffset` or 32-bit `ImDrawIdx`)
+constexpr int N_MESH_COLS = 480;
+constexpr int N_MESH_ROWS = 360;  // 6 vertices per anti-aliased triangle
+
+// Buffer ranges of the mesh in its draw list (For `CheckMesh`)
+struct MeshRange {
+    const ImDrawList* draw_list = nullptr;
+    int vtx_begin = 0;
+    int vtx_end = 0;
+    int idx_begin = 0;
+    int idx_end = 0;
+};
+MeshRange g_mesh_range;
+
+void DrawMesh(int frame_idx) {
+    const ImVec2& display_size = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos({0.f, 0.f}, ImGuiCond_Always);
+    ImGui::SetNextWindowSize(display_size, ImGuiCond_Always);
+    ImGui::Begin("Mesh");
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const ImVec2 avail = ImGui::GetContentRegionAvail();
+    const float cell_w = avail.x / static_cast<float>(N_MESH_COLS);
+    const float cell_h = avail.y / static_cast<float>(N_MESH_ROWS);
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    g_mesh_range.draw_list = draw_list;
+    g_mesh_range.vtx_begin = draw_list->VtxBuffer.Size;
+    g_mesh_range.idx_begin = draw_list->IdxBuffer.Size;
+    for (int row = 0; row < N_MESH_ROWS; row++) {
+        for (int col = 0; col < N_MESH_COLS; col++) {
+            const float x = origin.x + cell_w * static_cast<float>(col);
+            const float y = origin.y + cell_h * static_cast<float>(row);
+            const int shade = (row * 7 + col * 3 + frame_idx) & 0xFF;
+            draw_list->AddTriangleFilled(
+                    {x, y}, {x + cell_w, y}, {x, y + cell_h},
+                    IM_COL32(shade, 255 - shade, 128, 255));
+        }
+    }
+    g_mesh_range.vtx_end = draw_list->VtxBuffer.Size;
+    g_mesh_range.idx_end = draw_list->IdxBuffer.Size;
+    ImGui::End();
+}
+
+// Returns an error message for invalid draw data of the mesh, or empty.
+// 16-bit indices are relative to `VtxOffset`, so a list which is not split
+// wraps around at 65536 instead, and misses its last vertices.
+std::string CheckMeshDrawData(const ImDrawData* draw_data) {
+    const ImGuiIO& io = ImGui::GetIO();
+    if (!(io.BackendFlags & ImGuiBackendFlags_RendererHasVtxOffset)) {
+        return "RendererHasVtxOffset is not set";
+    }
+    const MeshRange& mesh = g_mesh_range;
+    ImDrawList* const* lists_begin = draw_data->CmdLists;
+    ImDrawList* const* lists_end = lists_begin + draw_data->CmdListsCount;
+    if (std::find(lists_begin, lists_end, mesh.draw_list) == lists_end) {
+        return "Mesh draw list is not rendered";
+    }
+
+    const ImDrawList* list = mesh.draw_list;
+    int n_cmds = 0;
+    int min_vtx = list->VtxBuffer.Size;
+    int max_vtx = -1;
+    for (int i = 0; i < list->CmdBuffer.Size; i++) {
+        const ImDrawCmd& cmd = list->CmdBuffer[i];
+        const int idx_begin =
+                std::max(static_cast<int>(cmd.IdxOffset), mesh.idx_begin);
+        const int idx_end = std::min(
+                static_cast<int>(cmd.IdxOffset + cmd.ElemCount), mesh.idx_end);
+        if (cmd.UserCallback || idx_end <= idx_begin) {
+            continue;
+        }
+        n_cmds++;
+        for (int j = idx_begin; j < idx_end; j++) {
+            const uint32_t idx = list->IdxBuffer[j];
+            const int vtx = static_cast<int>(cmd.VtxOffset + idx);
+            if (list->VtxBuffer.Size <= vtx) {
+                return "Index out of the vertex buffer";
+            }
+            min_vtx = std::min(min_vtx, vtx);
+            max_vtx = std::max(max_vtx, vtx);
+        }
+    }
+    if (min_vtx != mesh.vtx_begin || max_vtx != mesh.vtx_end - 1) {
+        return "Indices do not cover the vertices of the mesh";
+    }
+    if (sizeof(ImDrawIdx) == 4 && n_cmds != 1) {
+        return "Mesh is split into " + std::to_string(n_cmds) +
+               " commands with 32-bit indices";
+    }
+    return {};
+}
+
+std::vector<uint8_t> RenderMeshPath(const OffscreenEnv& env,
+                                    ImDrawData* draw_data,
+                                    ImGui_ImplVulkanHpp_Options options,
+                                    ImGui_ImplVulkanHpp_VertexFormat format,
+                                    bool vertex_pulling, bool instanced_quads) {
+    options.vertex_format = format;
+    options.vertex_pulling = vertex_pulling;
+    options.instanced_quads = instanced_quads;
+    ImGui_ImplVulkanHpp_SetOptions(options);
+    ImGui_ImplVulkanHpp_RenderDrawData(
+            draw_data, env.cmd_bufs_pack->cmd_bufs[0],
+            env.dst_img_pack->view.get(), env.dst_img_format,
+            env.dst_img_size, vk::ImageLayout::eTransferSrcOptimal);
+    SubmitAndWait(env);
+    return ReadDstImage(env);
+}
+
+// Renders the mesh through the pulled and packed paths, and compares them with
+// the plain path of the same vertex format, which uses ImGui's indices as they
+// are. (Narrowed indices drop or misplace triangles. Compact formats are not
+// compared with float ones, since quantized positions move edges)
+std::string CheckMeshPixels(const OffscreenEnv& env, ImDrawData* draw_data) {
+    using VertexFormat = ImGui_ImplVulkanHpp_VertexFormat;
+    const ImGui_ImplVulkanHpp_Options options =
+            ImGui_ImplVulkanHpp_GetOptions();
+    const size_t row_bytes = env.dst_img_size.width * 4;
+    std::string error;
+    for (auto format : {VertexFormat::Float, VertexFormat::Compact}) {
+        const char* format_name =
+                (format == VertexFormat::Compact) ? "compact" : "float";
+        const std::vector<uint8_t> ref_pixels = RenderMeshPath(
+                env, draw_data, options, format, false, false);
+        for (bool instanced_quads : {false, true}) {
+            const std::vector<uint8_t> pixels =
+                    RenderMeshPath(env, draw_data, options, format,
+                                   !instanced_quads, instanced_quads);
+            const size_t n_diffs =
+                    CountPixelDiffs(ref_pixels.data(), row_bytes,
+                                    pixels.data(), row_bytes, env.dst_img_size);
+            if (n_diffs != 0 && error.empty()) {
+                error = std::to_string(n_diffs) + " pixels of " +
+                        (instanced_quads ? "packed " : "pulled ") +
+                        format_name + " vertices differ";
+            }
+        }
+    }
+    ImGui_ImplVulkanHpp_SetOptions(options);
+    return error;
+}
+
+std::string CheckMesh(const OffscreenEnv& env, ImDrawData* draw_data) {
+    const std::string error = CheckMeshDrawData(draw_data);
+    return error.empty() ? CheckMeshPixels(env, draw_data) : error;
+}
+
+// -----------------------------------------------------------------------------
+// ----------------------------------- Runner ----------------------------------
+// -----------------------------------------------------------------------------
+// Returns an error message for invalid draw data or pixels, or empty
+// (Called with the last frame)
+using ScenarioCheck =
+        std::function<std::string(const OffscreenEnv&, ImDrawData*)>;
+
+struct Args {
+    std::vector<std::string> scenarios = {"demo",     "tables",   "text",
+                                          "windows",  "plot_cpu", "plot_gpu",
+                                          "icons",    "streams",  "mesh"};
+    int n_warmup = 30;
+    int n_frames = 300;
+    vk::Extent2D size = {1920, 1080};
+    std::string json_path;
+    std::string capture_prefix;
+    std::string trace_path;
+    ImGui_ImplVulkanHpp_VertexFormat vertex_format =
+            ImGui_ImplVulkanHpp_VertexFormat::Float;
+    bool vertex_pulling = false;
+    bool instanced_quads = false;
+    std::string bg_mode = "none";
+    float overlay_scale = 1.f;
+    bool check = false;
+    bool debug = false;
+};
+
+void PrintUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]" << std::endl
+              << "  --scenario NAME   demo|tables|text|windows|plot_cpu|"
+              << "plot_gpu|icons|streams|mesh|all"
+              << " (repeatable, default: all)" << std::endl
+              << "  --frames N        measured frames (default: 300)"
+              << std::endl
+              << "  --warmup N        warmup frames (default: 30)" << std::endl
+              << "  --size WxH        target size (default: 1920x1080)"
+              << std::endl
+              << "  --json PATH       write JSON Lines results ('-': stdout)"
+              << std::endl
+              << "  --capture PREFIX  capture draw data into PREFIX_NAME.ivhc"
+              << std::endl
+              << "  --trace PATH      write trace JSON (IMGUIVKHPP_TRACE=ON)"
+              << std::endl
+              << "  --vertex-format F float|compact (default: float)"
+              << std::endl
+              << "  --vertex-pulling  read vertices from storage buffer"
+              << std::endl
+              << "  --instanced-quads draw rectangles as instances"
+              << std::endl
+              << "  --bg MODE         none|auto|copy|blit|shader"
+              << " (default: none)" << std::endl
+              << "  --overlay-scale S draw ImGui at S times the resolution"
+              << std::endl
+              << "  --check           fail on invalid draw data or pixels "
+                 "(mesh)"
+              << std::endl
+              << "  --debug           enable validation layers" << std::endl;
+}
+
+bool GetBgComposite(const std::string& mode,
+                    ImGui_ImplVulkanHpp_BgComposite* bg_composite) {
+    using BgComposite = ImGui_ImplVulkanHpp_BgComposite;
+    BgComposite ret = BgComposite::Auto;
+    if (mode == "auto") {
+        ret = BgComposite::Auto;
+    } else if (mode == "copy") {
+        ret = BgComposite::Copy;
+    } else if (mode == "blit") {
+        ret = BgComposite::Blit;
+    } else if (mode == "shader") {
+        ret = BgComposite::Shader;
+    } else {
+        return false;
+    }
+    if (bg_composite) {
+        *bg_composite = ret;
+    }
+    return true;
+}
+
+Scenario GetScenario(const std::string& name) {
+    if (name == "demo") return DrawDemo;
+    if (name == "tables") return DrawLargeTable;
+    if (name == "text") return DrawDenseText;
+    if (name == "windows") return DrawManyWindows;
+    if (name == "plot_cpu") return DrawCpuPlot;
+    if (name == "plot_gpu") return DrawGpuPlot;
+    if (name == "icons") return DrawIcons;
+    if (name == "streams") return DrawStreams;
+    if (name == "mesh") return DrawMesh;
+    return nullptr;
+}
+
+ScenarioCheck GetScenarioCheck(const std::string& name) {
+    if (name == "mesh") return CheckMesh;
+    return nullptr;
+}
+
+bool ParseArgs(int argc, char const* argv[], Args& args) {
+    std::vector<std::string> scenarios;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_val = (i + 1 < argc);
+        if (arg == "--scenario" && has_val) {
+            const std::string val = argv[++i];
+            if (val != "all") {
+                if (!GetScenario(val)) {
+                    std::cerr << "Unknown scenario: " << val << std::endl;
+                    return false;
+                }
+                scenarios.push_back(val);
+            }
+        } else if (arg == "--frames" && has_val) {
+            args.n_frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--warmup" && has_val) {
+            args.n_warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--size" && has_val) {
+            unsigned w = 0, h = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &w, &h) != 2 || !w || !h) {
+                return false;
+            }
+            args.size = vk::Extent2D{w, h};
+        } else if (arg == "--json" && has_val) {
+            args.json_path = argv[++i];
+        } else if (arg == "--capture" && has_val) {
+            args.capture_prefix = argv[++i];
+        } else if (arg == "--trace" && has_val) {
+            args.trace_path = argv[++i];
+        } else if (arg == "--vertex-format" && has_val) {
+            const std::string val = argv[++i];
+            if (val == "float") {
+                args.vertex_format = ImGui_ImplVulkanHpp_VertexFormat::Float;
+            } else if (val == "compact") {
+                args.vertex_format = ImGui_ImplVulkanHpp_VertexFormat::Compact;
+            } else {
+                return false;
+            }
+        } else if (arg == "--vertex-pulling") {
+            args.vertex_pulling = true;
+        } else if (arg == "--instanced-quads") {
+            args.instanced_quads = true;
+        } else if (arg == "--bg" && has_val) {
+            args.bg_mode = argv[++i];
+            if (args.bg_mode != "none" &&
+                !GetBgComposite(args.bg_mode, nullptr)) {
+                return false;
+            }
+        } else if (arg == "--overlay-scale" && has_val) {
+            args.overlay_scale = static_cast<float>(std::atof(argv[++i]));
+            if (!(0.f < args.overlay_scale && args.overlay_scale <= 1.f)) {
+                return false;
+            }
+        } else if (arg == "--check") {
+            args.check = true;
+        } else if (arg == "--debug") {
+            args.debug = true;
+        } else {
+            return false;
+        }
+    }
+    if (!scenarios.empty()) {
+        args.scenarios = scenarios;
+    }
+    return true;
+}
+
+Samples RunScenario(const OffscreenEnv& env, const Scenario& scenario,
+                    const ScenarioCheck& check,
+                    const vkw::ImagePackPtr& bg_img_pack, const Args& args,
+                    std::string& check_error) {
+    using Clock = std::chrono::steady_clock;
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = {static_cast<float>(args.size.width),
+                      static_cast<float>(args.size.height)};
+    io.DeltaTime = 1.f / 60.f;
+
+    Samples samples;
+    auto& cmd_buf = env.cmd_bufs_pack->cmd_bufs[0];
+    for (int i = 0; i < args.n_warmup + args.n_frames; i++) {
+        // Build ImGui frame
+        ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+        ImGui::NewFrame();
+        scenario(i);
+        ImGui::Render();
+        ImDrawData* draw_data = ImGui::GetDrawData();
+
+        // Record
+        const auto rec_start = Clock::now();
+        vk::ImageView bg_img_view;
+        if (bg_img_pack) {
+            ImGui_ImplVulkanHpp_BgImages bg_imgs;
+            bg_imgs.bg_img = bg_img_pack->img.get();
+            bg_imgs.bg_img_format = env.dst_img_format;
+            bg_imgs.bg_img_size = env.dst_img_size;
+            bg_imgs.dst_img = env.dst_img_pack->img.get();
+            ImGui_ImplVulkanHpp_SetBgImages(bg_imgs);
+            bg_img_view = bg_img_pack->view.get();
+        }
+        ImGui_ImplVulkanHpp_RenderDrawData(
+                draw_data, cmd_buf, env.dst_img_pack->view.get(),
+                env.dst_img_format, env.dst_img_size,
+                vk::ImageLayout::eTransferSrcOptimal, bg_img_view,
+                vk::ImageLayout::eShaderReadOnlyOptimal);
+        const auto rec_end = Clock::now();
+
+        // Execute
+        SubmitAndWait(env);
+        const auto exec_end = Clock::now();
+
+        if (i < args.n_warmup) {
+            continue;
+        }
+        AddFrameSamples(samples, draw_data, rec_end - rec_start,
+                        exec_end - rec_end);
+        if (!args.capture_prefix.empty()) {
+            ImGui_ImplVulkanHpp_CaptureFrame(draw_data);
+        }
+    }
+
+    // GPU time over the last frames (Rolling window of the backend)
+    const auto& timings = ImGui_ImplVulkanHpp_GetGpuTimings();
+    if (timings.n_samples) {
+        samples.add("gpu_bg_ms", timings.bg.avg_ms);
+        samples.add("gpu_imgui_ms", timings.imgui.avg_ms);
+        samples.add("gpu_total_ms", timings.total.avg_ms);
+    }
+
+    // Last frame is still valid until the next `ImGui::NewFrame`
+    if (check) {
+        check_error = check(env, ImGui::GetDrawData());
+    }
+    return samples;
+}
+
+}  // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    Args args;
+    if (!ParseArgs(argc, argv, args)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // Output for machine-readable results
+    FILE* json_fp = nullptr;
+    if (!OpenJsonOutput(args.json_path, json_fp)) {
+        std::cerr << "Failed to open " << args.json_path << std::endl;
+        return 1;
+    }
+
+    // Initialize headless Vulkan
+    auto env = CreateOffscreenEnv("ImGui-VulkanHpp Bench", args.size,
+                                  args.debug);
+    const std::string device_name = GetDeviceName(env);
+    vkw::ImagePackPtr bg_img_pack;
+    if (args.bg_mode != "none") {
+        bg_img_pack = CreateBgImage(env);
+    }
+
+    // Human-readable results (Moved to stderr when JSON goes to stdout)
+    FILE* text_fp = (json_fp == stdout) ? stderr : stdout;
+    std::fprintf(text_fp, "Device: %s\n", device_name.c_str());
+
+    int exit_code = 0;
+    for (auto&& name : args.scenarios) {
+        const Scenario scenario = GetScenario(name);  // Validated
+        if (name == "plot_cpu" || name == "plot_gpu") {
+            PreparePlotData(env);
+        }
+
+        // Capture measured frames for `imgui_vkhpp_replay`
+        if (!args.capture_prefix.empty()) {
+            const std::string path = args.capture_prefix + "_" + name + ".ivhc";
+            if (!ImGui_ImplVulkanHpp_BeginCapture(path.c_str())) {
+                std::cerr << "Failed to open " << path << std::endl;
+                exit_code = 1;
+                break;
+            }
+        }
+
+        // Fresh context for each scenario
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGui::GetIO().IniFilename = nullptr;
+        ImGui::StyleColorsDark();
+        ImGui_ImplVulkanHpp_Init();
+        ImGui_ImplVulkanHpp_Options options;
+        options.gpu_timing = true;
+        options.vertex_format = args.vertex_format;
+        options.vertex_pulling = args.vertex_pulling;
+        options.instanced_quads = args.instanced_quads;
+        options.overlay_scale = args.overlay_scale;
+        if (bg_img_pack) {
+            GetBgComposite(args.bg_mode, &options.bg_composite);
+        }
+        ImGui_ImplVulkanHpp_SetOptions(options);
+
+        const ScenarioCheck check =
+                args.check ? GetScenarioCheck(name) : nullptr;
+        std::string check_error;
+        const Samples samples = RunScenario(env, scenario, check, bg_img_pack,
+                                            args, check_error);
+        ImGui_ImplVulkanHpp_EndCapture();
+        PrintText(text_fp, name, samples);
+        if (check) {
+            if (check_error.empty()) {
+                std::fprintf(text_fp, "Check: Passed\n");
+            } else {
+                std::fprintf(text_fp, "Check: Failed (%s)\n",
+                             check_error.c_str());
+                exit_code = 1;
+            }
+        }
+        if (json_fp) {
+            PrintJson(json_fp, device_name, name, args.size.width,
+                      args.size.height, args.n_frames, samples);
+        }
+
+        // Wait for the last usage before releasing backend resources
+        env.device->waitIdle();
+        ImGui_ImplVulkanHpp_Shutdown();
+        ImGui::DestroyContext();
+    }
+
+    CloseJsonOutput(json_fp);
+    if (!args.trace_path.empty() &&
+        !ImGui_ImplVulkanHpp_WriteTrace(args.trace_path.c_str())) {
+        std::cerr << "Failed to write trace (Needs IMGUIVKHPP_TRACE=ON): "
+                  << args.trace_path << std::endl;
+    }
+    g_plot_data = {};  // Release before the device
+    return exit_code;
+}
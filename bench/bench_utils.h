@@ -0,0 +1,364 @@
+#ifndef BENCH_UTILS_H_20261018
+#define BENCH_UTILS_H_20261018
+
+#include <imgui.h>
+#include <imgui_impl_vulkanhpp.h>
+#include <imgui_impl_vulkanhpp_capture.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// --------------------------------- Statistics --------------------------------
+// -----------------------------------------------------------------------------
+struct Summary {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+};
+
+inline Summary Summarize(std::vector<double> values) {
+    Summary summary;
+    if (values.empty()) {
+        return summary;
+    }
+    std::sort(values.begin(), values.end());
+    for (auto&& v : values) {
+        summary.mean += v;
+    }
+    summary.mean /= static_cast<double>(values.size());
+    auto percentile = [&](double p) {
+        const size_t idx = static_cast<size_t>(
+                p * static_cast<double>(values.size() - 1) + 0.5);
+        return values[idx];
+    };
+    summary.p50 = percentile(0.50);
+    summary.p95 = percentile(0.95);
+    summary.max = values.back();
+    return summary;
+}
+
+// Per-frame samples of one run
+struct Samples {
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> values;
+
+    void add(const std::string& name, double value) {
+        auto it = std::find(names.begin(), names.end(), name);
+        if (it == names.end()) {
+            names.push_back(name);
+            values.emplace_back();
+            it = names.end() - 1;
+        }
+        values[static_cast<size_t>(it - names.begin())].push_back(value);
+    }
+};
+
+// Collect the backend statistics of the last `RenderDrawData` call
+inline void AddFrameSamples(
+        Samples& samples, const ImDrawData* draw_data,
+        const std::chrono::steady_clock::duration& rec_time,
+        const std::chrono::steady_clock::duration& exec_time) {
+    auto to_us = [](const std::chrono::steady_clock::duration& d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    };
+    const auto& stats = ImGui_ImplVulkanHpp_GetFrameStats();
+    samples.add("render_draw_data_us", to_us(rec_time));
+    samples.add("update_font_tex_us", stats.update_font_tex_us);
+    samples.add("update_vtx_idx_bufs_us", stats.update_vtx_idx_bufs_us);
+    samples.add("update_render_pipeline_us", stats.update_render_pipeline_us);
+    samples.add("update_unif_buf_us", stats.update_unif_buf_us);
+    samples.add("record_draw_cmds_us", stats.record_draw_cmds_us);
+    samples.add("submit_wait_us", to_us(exec_time));
+    samples.add("uploaded_bytes", static_cast<double>(stats.uploaded_bytes));
+    samples.add("draw_calls", stats.n_draw_calls);
+    samples.add("scissor_calls", stats.n_scissor_calls);
+    samples.add("bind_calls", stats.n_bind_calls);
+    samples.add("culled_cmds", stats.n_culled_cmds);
+    samples.add("buf_reallocs", stats.n_buf_reallocs);
+    samples.add("quads_instanced", stats.n_quads_instanced);
+    samples.add("tex_updates", stats.n_tex_updates);
+    samples.add("pipeline_rebuilds", stats.n_pipeline_rebuilds);
+    samples.add("frame_buf_rebuilds", stats.n_frame_buf_rebuilds);
+    samples.add("bg_transfers", stats.n_bg_transfers);
+    samples.add("retired_objs", stats.n_retired_objs);
+    samples.add("skipped_overlays", stats.n_skipped_overlays);
+    const auto& mem_stats = ImGui_ImplVulkanHpp_GetMemoryStats();
+    samples.add("mem_reserved_bytes",
+                static_cast<double>(mem_stats.reserved_bytes));
+    samples.add("mem_used_bytes", static_cast<double>(mem_stats.used_bytes));
+    samples.add("mem_blocks", mem_stats.n_blocks);
+    samples.add("desc_pools", mem_stats.n_desc_pools);
+    samples.add("desc_sets", mem_stats.n_desc_sets);
+    int n_imgui_cmds = 0;  // Before merging (ImGui splits at 64K vertices)
+    for (int n = 0; n < draw_data->CmdListsCount; n++) {
+        n_imgui_cmds += draw_data->CmdLists[n]->CmdBuffer.Size;
+    }
+    samples.add("imgui_cmds", n_imgui_cmds);
+    samples.add("vertices", draw_data->TotalVtxCount);
+    samples.add("indices", draw_data->TotalIdxCount);
+}
+
+inline void PrintText(FILE* fp, const std::string& title,
+                      const Samples& samples) {
+    std::fprintf(fp, "[%s]\n", title.c_str());
+    std::fprintf(fp, "  %-28s %12s %12s %12s %12s\n", "metric", "mean", "p50",
+                 "p95", "max");
+    for (size_t i = 0; i < samples.names.size(); i++) {
+        const Summary s = Summarize(samples.values[i]);
+        std::fprintf(fp, "  %-28s %12.2f %12.2f %12.2f %12.2f\n",
+                     samples.names[i].c_str(), s.mean, s.p50, s.p95, s.max);
+    }
+}
+
+// Quotes and escapes a string for JSON (e.g. device names and file paths)
+inline std::string JsonString(const std::string& str) {
+    std::string ret = "\"";
+    for (auto&& c : str) {
+        if (c == '"' || c == '\\') {
+            ret += '\\';
+            ret += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x",
+                          static_cast<unsigned>(c));
+            ret += buf;
+        } else {
+            ret += c;
+        }
+    }
+    ret += '"';
+    return ret;
+}
+
+inline void PrintJson(FILE* fp, const std::string& device_name,
+                      const std::string& scenario, unsigned width,
+                      unsigned height, int n_frames, const Samples& samples) {
+    // One JSON object per line (JSON Lines) for regression tracking
+    std::fprintf(fp,
+                 "{\"device\": %s, \"scenario\": %s, "
+                 "\"width\": %u, \"height\": %u, \"frames\": %d, "
+                 "\"metrics\": {",
+                 JsonString(device_name).c_str(),
+                 JsonString(scenario).c_str(), width, height, n_frames);
+    for (size_t i = 0; i < samples.names.size(); i++) {
+        const Summary s = Summarize(samples.values[i]);
+        std::fprintf(fp,
+                     "%s\"%s\": {\"mean\": %.3f, \"p50\": %.3f, "
+                     "\"p95\": %.3f, \"max\": %.3f}",
+                     (i == 0) ? "" : ", ", samples.names[i].c_str(), s.mean,
+                     s.p50, s.p95, s.max);
+    }
+    std::fprintf(fp, "}}\n");
+}
+
+// Open JSON output ('-' means stdout, empty means disabled)
+inline bool OpenJsonOutput(const std::string& path, FILE*& json_fp) {
+    json_fp = nullptr;
+    if (path == "-") {
+        json_fp = stdout;
+    } else if (!path.empty()) {
+        json_fp = std::fopen(path.c_str(), "w");
+        if (!json_fp) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline void CloseJsonOutput(FILE* json_fp) {
+    if (json_fp && json_fp != stdout) {
+        std::fclose(json_fp);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// --------------------------------- Arguments ---------------------------------
+// -----------------------------------------------------------------------------
+// Options of the tools which draw frames of their own
+struct FrameArgs {
+    int n_frames = 300;
+    int n_warmup = 10;
+    unsigned width = 1280;
+    unsigned height = 720;
+    std::string ppm_path;
+    std::string json_path;
+    bool debug = false;
+};
+
+inline void PrintFrameUsage(const char* prog, const char* ppm_desc) {
+    std::cerr << "Usage: " << prog << " [options]" << std::endl
+              << "  --frames N        measured frames (default: 300)"
+              << std::endl
+              << "  --warmup N        unmeasured frames (default: 10)"
+              << std::endl
+              << "  --size WxH        target size (default: 1280x720)"
+              << std::endl
+              << "  --ppm PATH        " << ppm_desc << std::endl
+              << "  --json PATH       write JSON Lines results ('-': stdout)"
+              << std::endl
+              << "  --debug           enable validation layers" << std::endl;
+}
+
+// Parses the option at `i`, and advances `i` over its value.
+// (False for unknown or invalid options)
+inline bool ParseFrameArg(int argc, char const* argv[], int& i,
+                          FrameArgs& args) {
+    const std::string arg = argv[i];
+    const bool has_val = (i + 1 < argc);
+    if (arg == "--frames" && has_val) {
+        args.n_frames = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--warmup" && has_val) {
+        args.n_warmup = std::max(0, std::atoi(argv[++i]));
+    } else if (arg == "--size" && has_val) {
+        if (std::sscanf(argv[++i], "%ux%u", &args.width, &args.height) != 2) {
+            return false;
+        }
+    } else if (arg == "--ppm" && has_val) {
+        args.ppm_path = argv[++i];
+    } else if (arg == "--json" && has_val) {
+        args.json_path = argv[++i];
+    } else if (arg == "--debug") {
+        args.debug = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+inline bool ParseFrameArgs(int argc, char const* argv[], FrameArgs& args) {
+    for (int i = 1; i < argc; i++) {
+        if (!ParseFrameArg(argc, argv, i, args)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Options of the tools which replay a capture
+struct ReplayArgs {
+    std::string capture_path;
+    int n_loops = 1;
+    int n_warmup = 10;
+    std::string json_path;
+    bool debug = false;
+};
+
+inline void PrintReplayUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " CAPTURE.ivhc [options]" << std::endl
+              << "  --loops N         replay the capture N times (default: 1)"
+              << std::endl
+              << "  --warmup N        unmeasured frames (default: 10)"
+              << std::endl
+              << "  --json PATH       write JSON Lines results ('-': stdout)"
+              << std::endl
+              << "  --debug           enable validation layers" << std::endl;
+}
+
+inline bool ParseReplayArgs(int argc, char const* argv[], ReplayArgs& args) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_val = (i + 1 < argc);
+        if (arg == "--loops" && has_val) {
+            args.n_loops = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--warmup" && has_val) {
+            args.n_warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--json" && has_val) {
+            args.json_path = argv[++i];
+        } else if (arg == "--debug") {
+            args.debug = true;
+        } else if (args.capture_path.empty() && arg[0] != '-') {
+            args.capture_path = arg;
+        } else {
+            return false;
+        }
+    }
+    return !args.capture_path.empty();
+}
+
+// -----------------------------------------------------------------------------
+// ----------------------------------- Replay ----------------------------------
+// -----------------------------------------------------------------------------
+// Opens a capture, whose first frame decides the target size.
+// (Null for invalid captures)
+inline ImGui_ImplVulkanHpp_Replay* OpenReplayCapture(const std::string& path,
+                                                     int& n_frames,
+                                                     vk::Extent2D& size) {
+    auto replay = ImGui_ImplVulkanHpp_OpenReplay(path.c_str());
+    n_frames = ImGui_ImplVulkanHpp_GetReplayFrameCount(replay);
+    if (n_frames == 0) {
+        std::cerr << "Invalid capture: " << path << std::endl;
+        ImGui_ImplVulkanHpp_CloseReplay(replay);
+        return nullptr;
+    }
+    const ImDrawData* first = ImGui_ImplVulkanHpp_GetReplayFrame(replay, 0, {});
+    size = vk::Extent2D{
+            static_cast<uint32_t>(first->DisplaySize.x *
+                                  first->FramebufferScale.x),
+            static_cast<uint32_t>(first->DisplaySize.y *
+                                  first->FramebufferScale.y)};
+    return replay;
+}
+
+// -----------------------------------------------------------------------------
+// ----------------------------------- Frames ----------------------------------
+// -----------------------------------------------------------------------------
+// Window with a counter and a progress bar over the demo window
+inline void DrawTestFrame(const char* title, int frame_idx,
+                          const ImVec2& win_size) {
+    ImGui::SetNextWindowPos({0.f, 0.f}, ImGuiCond_Always);
+    ImGui::SetNextWindowSize(win_size, ImGuiCond_Always);
+    ImGui::Begin(title);
+    ImGui::Text("Frame %d", frame_idx);
+    ImGui::ProgressBar(static_cast<float>(frame_idx % 100) / 100.f);
+    ImGui::End();
+    ImGui::ShowDemoWindow();
+}
+
+// Binary PPM from RGBA8 pixels (Alpha is dropped)
+inline bool WritePpm(const std::string& path, const uint8_t* pixels,
+                     const vk::Extent2D& size, size_t row_bytes) {
+    FILE* fp = std::fopen(path.c_str(), "wb");
+    if (!fp) {
+        return false;
+    }
+    std::fprintf(fp, "P6\n%u %u\n255\n", size.width, size.height);
+    std::vector<uint8_t> row(size.width * 3);
+    for (uint32_t y = 0; y < size.height; y++) {
+        const uint8_t* src = pixels + row_bytes * y;
+        for (uint32_t x = 0; x < size.width; x++) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        std::fwrite(row.data(), 1, row.size(), fp);
+    }
+    std::fclose(fp);
+    return true;
+}
+
+// Number of pixels which differ between two RGBA8 frames
+inline size_t CountPixelDiffs(const uint8_t* pixels0, size_t row_bytes0,
+                              const uint8_t* pixels1, size_t row_bytes1,
+                              const vk::Extent2D& size) {
+    size_t n_diffs = 0;
+    for (uint32_t y = 0; y < size.height; y++) {
+        const uint8_t* row0 = pixels0 + row_bytes0 * y;
+        const uint8_t* row1 = pixels1 + row_bytes1 * y;
+        for (uint32_t x = 0; x < size.width; x++) {
+            if (std::memcmp(row0 + x * 4, row1 + x * 4, 4) != 0) {
+                n_diffs++;
+            }
+        }
+    }
+    return n_diffs;
+}
+
+#endif /* end of include guard */
@@ -0,0 +1,384 @@
+#include <vkw/warning_suppressor.h>
+
+BEGIN_VKW_SUPPRESS_WARNING
+#include <imgui.h>
+#include <imgui_impl_vulkan.h>
+#include <imgui_impl_vulkanhpp.h>
+#include <imgui_impl_vulkanhpp_capture.h>
+END_VKW_SUPPRESS_WARNING
+
+#include <vkw/vkw.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "bench_utils.h"
+#include "offscreen.h"
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// --------------------------------- GPU Timer ---------------------------------
+// -----------------------------------------------------------------------------
+// Timestamps are written by separate command buffers submitted around the
+// measured one, so both backends are timed in exactly the same way.
+struct GpuTimer {
+    vk::UniqueQueryPool query_pool;
+    vkw::CommandBuffersPackPtr cmd_bufs_pack;  // [begin, end]
+    double timestamp_period_ns = 0.0;
+};
+
+GpuTimer CreateGpuTimer(const OffscreenEnv& env) {
+    GpuTimer timer;
+    const auto& limits = env.physical_device.getProperties().limits;
+    if (!limits.timestampComputeAndGraphics) {
+        return timer;  // Not supported
+    }
+    timer.timestamp_period_ns = static_cast<double>(limits.timestampPeriod);
+    timer.query_pool = env.device->createQueryPoolUnique(
+            {{}, vk::QueryType::eTimestamp, 2});
+    timer.cmd_bufs_pack = vkw::CreateCommandBuffersPack(
+            env.device, env.queue_family_idx, 2);
+
+    // Recorded once, and submitted every frame
+    auto& begin_cmd_buf = timer.cmd_bufs_pack->cmd_bufs[0];
+    vkw::BeginCommand(begin_cmd_buf, false);
+    begin_cmd_buf->resetQueryPool(timer.query_pool.get(), 0, 2);
+    begin_cmd_buf->writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe,
+                                  timer.query_pool.get(), 0);
+    vkw::EndCommand(begin_cmd_buf);
+    auto& end_cmd_buf = timer.cmd_bufs_pack->cmd_bufs[1];
+    vkw::BeginCommand(end_cmd_buf, false);
+    end_cmd_buf->writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe,
+                                timer.query_pool.get(), 1);
+    vkw::EndCommand(end_cmd_buf);
+    return timer;
+}
+
+// Submit the command buffer between the timestamps and wait [us]
+double SubmitTimedAndWait(const OffscreenEnv& env, const GpuTimer& timer,
+                          const vk::CommandBuffer& cmd_buf) {
+    if (!timer.query_pool) {
+        SubmitAndWait(env);
+        return 0.0;
+    }
+    const std::array<vk::CommandBuffer, 3> cmd_bufs = {
+            {timer.cmd_bufs_pack->cmd_bufs[0].get(), cmd_buf,
+             timer.cmd_bufs_pack->cmd_bufs[1].get()}};
+    env.device->resetFences(env.fence.get());
+    env.queue.submit(vk::SubmitInfo(0, nullptr, nullptr,
+                                    static_cast<uint32_t>(cmd_bufs.size()),
+                                    cmd_bufs.data()),
+                     env.fence.get());
+    const auto ret = env.device->waitForFences(env.fence.get(), VK_TRUE,
+                                               UINT64_MAX);
+    if (ret != vk::Result::eSuccess) {
+        throw std::runtime_error("Failed to wait for fence");
+    }
+
+    std::array<uint64_t, 2> results = {};
+    const auto query_ret = env.device->getQueryPoolResults(
+            timer.query_pool.get(), 0, 2, sizeof(results), results.data(),
+            sizeof(uint64_t),
+            vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+    if (query_ret != vk::Result::eSuccess) {
+        return 0.0;
+    }
+    return static_cast<double>(results[1] - results[0]) *
+           timer.timestamp_period_ns * 1e-3;
+}
+
+// -----------------------------------------------------------------------------
+// ------------------------------ Upstream Backend -----------------------------
+// -----------------------------------------------------------------------------
+// `imgui_impl_vulkan` draws inside a render pass begun by the application.
+// Its functions are loaded through the dispatcher of vulkan.hpp
+// (`IMGUI_IMPL_VULKAN_NO_PROTOTYPES`), since vkw may link Vulkan dynamically.
+struct UpstreamEnv {
+    vk::UniqueDescriptorPool desc_pool;
+    vk::UniqueRenderPass render_pass;
+    vk::UniqueFramebuffer frame_buf;
+    vkw::CommandBuffersPackPtr cmd_bufs_pack;
+};
+
+void CheckVkResult(VkResult err) {
+    if (err < 0) {
+        std::cerr << "imgui_impl_vulkan: VkResult " << err << std::endl;
+        std::abort();
+    }
+}
+
+PFN_vkVoidFunction LoadVkFunction(const char* name, void* user_data) {
+    const VkInstance instance = *static_cast<const VkInstance*>(user_data);
+    return VULKAN_HPP_DEFAULT_DISPATCHER.vkGetInstanceProcAddr(instance, name);
+}
+
+UpstreamEnv InitUpstream(const OffscreenEnv& env) {
+    UpstreamEnv up;
+
+    // Descriptor pool for the font texture
+    const vk::DescriptorPoolSize pool_size = {
+            vk::DescriptorType::eCombinedImageSampler, 16};
+    up.desc_pool = env.device->createDescriptorPoolUnique(
+            {vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, 16, 1,
+             &pool_size});
+
+    // Same attachment usage as `ImGui_ImplVulkanHpp_RenderDrawData` without BG
+    const vk::AttachmentDescription attach_desc = {
+            {},
+            env.dst_img_format,
+            vk::SampleCountFlagBits::e1,
+            vk::AttachmentLoadOp::eClear,
+            vk::AttachmentStoreOp::eStore,
+            vk::AttachmentLoadOp::eDontCare,
+            vk::AttachmentStoreOp::eDontCare,
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eTransferSrcOptimal};
+    const vk::AttachmentReference color_ref = {
+            0, vk::ImageLayout::eColorAttachmentOptimal};
+    const vk::SubpassDescription subpass_desc = {
+            {}, vk::PipelineBindPoint::eGraphics, 0, nullptr, 1, &color_ref};
+    up.render_pass = env.device->createRenderPassUnique(
+            {{}, 1, &attach_desc, 1, &subpass_desc});
+    const vk::ImageView dst_img_view = env.dst_img_pack->view.get();
+    up.frame_buf = env.device->createFramebufferUnique(
+            {{}, up.render_pass.get(), 1, &dst_img_view,
+             env.dst_img_size.width, env.dst_img_size.height, 1});
+    up.cmd_bufs_pack = vkw::CreateCommandBuffersPack(
+            env.device, env.queue_family_idx, 1);
+
+    // Initialize backend
+    VkInstance instance = env.instance.get();
+    ImGui_ImplVulkan_LoadFunctions(LoadVkFunction, &instance);
+    ImGui_ImplVulkan_InitInfo init_info = {};
+    init_info.Instance = env.instance.get();
+    init_info.PhysicalDevice = env.physical_device;
+    init_info.Device = env.device.get();
+    init_info.QueueFamily = env.queue_family_idx;
+    init_info.Queue = env.queue;
+    init_info.DescriptorPool = up.desc_pool.get();
+    init_info.MinImageCount = 2;
+    init_info.ImageCount = 2;
+    init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
+    init_info.CheckVkResultFn = CheckVkResult;
+    ImGui_ImplVulkan_Init(&init_info, up.render_pass.get());
+
+    // Upload font texture
+    auto& cmd_buf = up.cmd_bufs_pack->cmd_bufs[0];
+    vkw::ResetCommand(cmd_buf);
+    vkw::BeginCommand(cmd_buf, true);
+    ImGui_ImplVulkan_CreateFontsTexture(cmd_buf.get());
+    vkw::EndCommand(cmd_buf);
+    const vk::CommandBuffer raw_cmd_buf = cmd_buf.get();
+    env.queue.submit(vk::SubmitInfo(0, nullptr, nullptr, 1, &raw_cmd_buf),
+                     nullptr);
+    env.device->waitIdle();
+    ImGui_ImplVulkan_DestroyFontUploadObjects();
+
+    return up;
+}
+
+void RecordUpstream(const OffscreenEnv& env, const UpstreamEnv& up,
+                    ImDrawData* draw_data) {
+    auto& cmd_buf = up.cmd_bufs_pack->cmd_bufs[0];
+    vkw::ResetCommand(cmd_buf);
+    vkw::BeginCommand(cmd_buf, true);
+    const vk::ClearValue clear_val;
+    cmd_buf->beginRenderPass({up.render_pass.get(), up.frame_buf.get(),
+                              {{0, 0}, env.dst_img_size}, 1, &clear_val},
+                             vk::SubpassContents::eInline);
+    ImGui_ImplVulkan_RenderDrawData(draw_data, cmd_buf.get());
+    cmd_buf->endRenderPass();
+    vkw::EndCommand(cmd_buf);
+}
+
+// Upstream has no statistics, so they are derived from the draw data in the
+// same way as it uploads and draws. (Whole buffers every frame, and one draw
+// per command whose clip rect is not empty after clamping to the frame buffer)
+size_t CountUpstreamUploadedBytes(const ImDrawData* draw_data) {
+    return static_cast<size_t>(draw_data->TotalVtxCount) * sizeof(ImDrawVert) +
+           static_cast<size_t>(draw_data->TotalIdxCount) * sizeof(ImDrawIdx);
+}
+
+uint32_t CountUpstreamDrawCalls(const ImDrawData* draw_data) {
+    const ImVec2 pos = draw_data->DisplayPos;
+    const ImVec2 scale = draw_data->FramebufferScale;
+    const float fb_w = static_cast<float>(
+            static_cast<int>(draw_data->DisplaySize.x * scale.x));
+    const float fb_h = static_cast<float>(
+            static_cast<int>(draw_data->DisplaySize.y * scale.y));
+    if (fb_w <= 0.f || fb_h <= 0.f) {
+        return 0;
+    }
+    uint32_t n_draw_calls = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; n++) {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        for (int i = 0; i < cmd_list->CmdBuffer.Size; i++) {
+            const ImDrawCmd& cmd = cmd_list->CmdBuffer[i];
+            if (cmd.UserCallback) {
+                continue;
+            }
+            const float x0 = std::max((cmd.ClipRect.x - pos.x) * scale.x, 0.f);
+            const float y0 = std::max((cmd.ClipRect.y - pos.y) * scale.y, 0.f);
+            const float x1 = std::min((cmd.ClipRect.z - pos.x) * scale.x, fb_w);
+            const float y1 = std::min((cmd.ClipRect.w - pos.y) * scale.y, fb_h);
+            if (x0 < x1 && y0 < y1) {
+                n_draw_calls++;
+            }
+        }
+    }
+    return n_draw_calls;
+}
+
+// -----------------------------------------------------------------------------
+// ----------------------------------- Report ----------------------------------
+// -----------------------------------------------------------------------------
+void AddCompareSamples(Samples& samples,
+                       const std::chrono::steady_clock::duration& rec_time,
+                       double gpu_us, size_t uploaded_bytes,
+                       uint32_t n_draw_calls) {
+    samples.add("record_us",
+                std::chrono::duration<double, std::micro>(rec_time).count());
+    samples.add("gpu_us", gpu_us);
+    samples.add("uploaded_bytes", static_cast<double>(uploaded_bytes));
+    samples.add("draw_calls", n_draw_calls);
+}
+
+void PrintSideBySide(FILE* fp, const Samples& vkhpp, const Samples& upstream) {
+    std::fprintf(fp, "  %-16s %14s %14s %14s %14s %8s\n", "metric",
+                 "vkhpp mean", "vkhpp p95", "upstream mean", "upstream p95",
+                 "ratio");
+    for (size_t i = 0; i < vkhpp.names.size(); i++) {
+        const Summary s0 = Summarize(vkhpp.values[i]);
+        const Summary s1 = Summarize(upstream.values[i]);
+        const double ratio = (s1.mean != 0.0) ? s0.mean / s1.mean : 0.0;
+        std::fprintf(fp, "  %-16s %14.2f %14.2f %14.2f %14.2f %8.3f\n",
+                     vkhpp.names[i].c_str(), s0.mean, s0.p95, s1.mean, s1.p95,
+                     ratio);
+    }
+}
+
+}  // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    using Clock = std::chrono::steady_clock;
+
+    ReplayArgs args;
+    if (!ParseReplayArgs(argc, argv, args)) {
+        PrintReplayUsage(argv[0]);
+        return 1;
+    }
+
+    // Open capture
+    int n_frames = 0;
+    vk::Extent2D size;
+    auto replay = OpenReplayCapture(args.capture_path, n_frames, size);
+    if (!replay) {
+        return 1;
+    }
+
+    // Initialize headless Vulkan
+    auto env = CreateOffscreenEnv("ImGui-VulkanHpp Compare", size, args.debug);
+    const std::string device_name = GetDeviceName(env);
+    const GpuTimer timer = CreateGpuTimer(env);
+
+    FILE* json_fp = nullptr;
+    if (!OpenJsonOutput(args.json_path, json_fp)) {
+        std::cerr << "Failed to open " << args.json_path << std::endl;
+        ImGui_ImplVulkanHpp_CloseReplay(replay);
+        return 1;
+    }
+    FILE* text_fp = (json_fp == stdout) ? stderr : stdout;
+    std::fprintf(text_fp, "Device: %s\n", device_name.c_str());
+    std::fprintf(text_fp, "Capture: %s (%d frames, %ux%u)\n",
+                 args.capture_path.c_str(), n_frames, size.width, size.height);
+    if (!timer.query_pool) {
+        std::fprintf(text_fp, "GPU timestamps are not supported\n");
+    }
+
+    // Each backend has its own ImGui context (Only for the font atlas, which
+    // is built identically from the default font)
+    IMGUI_CHECKVERSION();
+    ImGuiContext* vkhpp_ctx = ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+    ImGui_ImplVulkanHpp_Init();
+    ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+    const ImTextureID vkhpp_font_id = ImGui::GetIO().Fonts->TexID;
+
+    ImGuiContext* upstream_ctx = ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+    const UpstreamEnv up = InitUpstream(env);
+    const ImTextureID upstream_font_id = ImGui::GetIO().Fonts->TexID;
+
+    // Replay frame by frame, alternating the backends
+    Samples vkhpp_samples, upstream_samples;
+    auto& cmd_buf = env.cmd_bufs_pack->cmd_bufs[0];
+    const int n_total = args.n_warmup + n_frames * args.n_loops;
+    for (int i = 0; i < n_total; i++) {
+        const bool is_measured = (args.n_warmup <= i);
+
+        // ImGui-VulkanHpp
+        ImGui::SetCurrentContext(vkhpp_ctx);
+        ImDrawData* draw_data = ImGui_ImplVulkanHpp_GetReplayFrame(
+                replay, i % n_frames, vkhpp_font_id);
+        auto rec_start = Clock::now();
+        ImGui_ImplVulkanHpp_RenderDrawData(
+                draw_data, cmd_buf, env.dst_img_pack->view.get(),
+                env.dst_img_format, env.dst_img_size,
+                vk::ImageLayout::eTransferSrcOptimal);
+        auto rec_end = Clock::now();
+        double gpu_us = SubmitTimedAndWait(env, timer, cmd_buf.get());
+        if (is_measured) {
+            const auto& stats = ImGui_ImplVulkanHpp_GetFrameStats();
+            AddCompareSamples(vkhpp_samples, rec_end - rec_start, gpu_us,
+                              stats.uploaded_bytes, stats.n_draw_calls);
+        }
+
+        // imgui_impl_vulkan
+        ImGui::SetCurrentContext(upstream_ctx);
+        draw_data = ImGui_ImplVulkanHpp_GetReplayFrame(replay, i % n_frames,
+                                                       upstream_font_id);
+        ImGui_ImplVulkan_NewFrame();
+        rec_start = Clock::now();
+        RecordUpstream(env, up, draw_data);
+        rec_end = Clock::now();
+        gpu_us = SubmitTimedAndWait(env, timer,
+                                    up.cmd_bufs_pack->cmd_bufs[0].get());
+        if (is_measured) {
+            AddCompareSamples(upstream_samples, rec_end - rec_start, gpu_us,
+                              CountUpstreamUploadedBytes(draw_data),
+                              CountUpstreamDrawCalls(draw_data));
+        }
+    }
+
+    std::fprintf(text_fp, "[compare]\n");
+    PrintSideBySide(text_fp, vkhpp_samples, upstream_samples);
+    if (json_fp) {
+        const int n_measured = n_total - args.n_warmup;
+        PrintJson(json_fp, device_name, args.capture_path + ":vkhpp",
+                  size.width, size.height, n_measured, vkhpp_samples);
+        PrintJson(json_fp, device_name, args.capture_path + ":upstream",
+                  size.width, size.height, n_measured, upstream_samples);
+    }
+    CloseJsonOutput(json_fp);
+
+    // Clean up
+    env.device->waitIdle();
+    ImGui::SetCurrentContext(upstream_ctx);
+    ImGui_ImplVulkan_Shutdown();
+    ImGui::DestroyContext(upstream_ctx);
+    ImGui::SetCurrentContext(vkhpp_ctx);
+    ImGui_ImplVulkanHpp_Shutdown();
+    ImGui::DestroyContext(vkhpp_ctx);
+    ImGui_ImplVulkanHpp_CloseReplay(replay);
+
+    return 0;
+}
@@ -0,0 +1,435 @@
+#include <vkw/warning_suppressor.h>
+
+BEGIN_VKW_SUPPRESS_WARNING
+#include <imgui.h>
+#include <imgui_impl_vulkanhpp.h>
+END_VKW_SUPPRESS_WARNING
+
+#include <vkw/vkw.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bench_utils.h"
+#include "offscreen.h"
+
+namespace {
+
+const std::vector<const char*> EXTERNAL_EXTS = {
+        VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME,
+        VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME};
+
+uint32_t FindMemTypeIdx(const vk::PhysicalDevice& physical_device,
+                        uint32_t type_bits,
+                        const vk::MemoryPropertyFlags& props) {
+    const auto& mem_props = physical_device.getMemoryProperties();
+    for (uint32_t i = 0; i < mem_props.memoryTypeCount; i++) {
+        if ((type_bits & (1u << i)) &&
+            (mem_props.memoryTypes[i].propertyFlags & props) == props) {
+            return i;
+        }
+    }
+    throw std::runtime_error("Failed to find memory type");
+}
+
+// -----------------------------------------------------------------------------
+// ---------------------------------- Importer ---------------------------------
+// -----------------------------------------------------------------------------
+// Stands for the compositor process. It owns another logical device and only
+// sees fds of the exported targets.
+struct ImportedTarget {
+    vk::UniqueImage img;
+    vk::UniqueDeviceMemory mem;
+    vk::UniqueSemaphore ready_semaphore;
+    vk::UniqueSemaphore release_semaphore;
+    vk::UniqueFence fence;  // Last composite of this target (Created signaled)
+};
+
+struct Importer {
+    vk::UniqueDevice device;
+    vk::Queue queue;
+    vkw::CommandBuffersPackPtr cmd_bufs_pack;  // One for each target
+    std::vector<ImportedTarget> targets;
+
+    vk::UniqueBuffer dst_buf;  // Host visible copy of the composited frame
+    vk::UniqueDeviceMemory dst_mem;
+    const uint8_t* dst_p = nullptr;
+    vk::Extent2D size;
+};
+
+ImportedTarget ImportTarget(
+        const vk::PhysicalDevice& physical_device,
+        const vk::UniqueDevice& device,
+        const ImGui_ImplVulkanHpp_ExportedTarget& exported) {
+    ImportedTarget target;
+    const vk::ExternalMemoryImageCreateInfo ext_info = {
+            vk::ExternalMemoryHandleTypeFlagBits::eOpaqueFd};
+    vk::ImageCreateInfo img_info = {
+            {},
+            vk::ImageType::e2D,
+            exported.format,
+            {exported.size.width, exported.size.height, 1},
+            1,
+            1,
+            vk::SampleCountFlagBits::e1,
+            vk::ImageTiling::eOptimal,
+            exported.usage};
+    img_info.pNext = &ext_info;
+    target.img = device->createImageUnique(img_info);
+
+    // The fd is consumed by the import
+    const auto reqs = device->getImageMemoryRequirements(target.img.get());
+    const vk::MemoryDedicatedAllocateInfo dedicated_info = {target.img.get()};
+    vk::ImportMemoryFdInfoKHR import_info = {
+            vk::ExternalMemoryHandleTypeFlagBits::eOpaqueFd, exported.mem_fd};
+    import_info.pNext = &dedicated_info;
+    vk::MemoryAllocateInfo alloc_info = {
+            exported.mem_size,
+            FindMemTypeIdx(physical_device, reqs.memoryTypeBits,
+                           vk::MemoryPropertyFlagBits::eDeviceLocal)};
+    alloc_info.pNext = &import_info;
+    target.mem = device->allocateMemoryUnique(alloc_info);
+    device->bindImageMemory(target.img.get(), target.mem.get(), 0);
+
+    // The fds are consumed by the imports as well
+    target.ready_semaphore = device->createSemaphoreUnique({});
+    device->importSemaphoreFdKHR(
+            {target.ready_semaphore.get(), {},
+             vk::ExternalSemaphoreHandleTypeFlagBits::eOpaqueFd,
+             exported.semaphore_fd});
+    target.release_semaphore = device->createSemaphoreUnique({});
+    device->importSemaphoreFdKHR(
+            {target.release_semaphore.get(), {},
+             vk::ExternalSemaphoreHandleTypeFlagBits::eOpaqueFd,
+             exported.release_semaphore_fd});
+    target.fence = device->createFenceUnique(
+            {vk::FenceCreateFlagBits::eSignaled});
+    return target;
+}
+
+void CreateImporterBuffer(const vk::PhysicalDevice& physical_device,
+                          Importer& importer) {
+    auto&& device = importer.device;
+    const vk::DeviceSize n_bytes =
+            static_cast<vk::DeviceSize>(importer.size.width) *
+            importer.size.height * 4;
+    importer.dst_buf = device->createBufferUnique(
+            {{}, n_bytes, vk::BufferUsageFlagBits::eTransferDst});
+    const auto reqs =
+            device->getBufferMemoryRequirements(importer.dst_buf.get());
+    const auto props = vk::MemoryPropertyFlagBits::eHostVisible |
+                       vk::MemoryPropertyFlagBits::eHostCoherent;
+    importer.dst_mem = device->allocateMemoryUnique(
+            {reqs.size, FindMemTypeIdx(physical_device, reqs.memoryTypeBits,
+                                       props)});
+    device->bindBufferMemory(importer.dst_buf.get(), importer.dst_mem.get(),
+                             0);
+    importer.dst_p = static_cast<const uint8_t*>(
+            device->mapMemory(importer.dst_mem.get(), 0, VK_WHOLE_SIZE));
+}
+
+void WaitFence(const vk::UniqueDevice& device, const vk::UniqueFence& fence) {
+    const auto ret = device->waitForFences(fence.get(), VK_TRUE, UINT64_MAX);
+    if (ret != vk::Result::eSuccess) {
+        throw std::runtime_error("Failed to wait for fence");
+    }
+}
+
+// Acquires a target from the producer, copies it like a compositor would, and
+// releases it back. Only the previous composite of the same target is waited
+// (For its command buffer), so the producer's next frame overlaps the copy.
+void CompositeTarget(Importer& importer, uint32_t target_idx,
+                     uint32_t queue_family_idx) {
+    auto& target = importer.targets[target_idx];
+    WaitFence(importer.device, target.fence);
+    auto& cmd_buf = importer.cmd_bufs_pack->cmd_bufs[target_idx];
+    vkw::ResetCommand(cmd_buf);
+    vkw::BeginCommand(cmd_buf, true);
+    // After the copies of other targets into the same buffer
+    const vk::MemoryBarrier after_copy = {vk::AccessFlagBits::eTransferWrite,
+                                          vk::AccessFlagBits::eTransferWrite};
+    const vk::ImageMemoryBarrier from_external = {
+            {},
+            vk::AccessFlagBits::eTransferRead,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eTransferSrcOptimal,
+            VK_QUEUE_FAMILY_EXTERNAL,
+            queue_family_idx,
+            target.img.get(),
+            {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}};
+    cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                             vk::PipelineStageFlagBits::eTransfer, {},
+                             after_copy, nullptr, from_external);
+    const vk::BufferImageCopy region = {
+            0,
+            0,
+            0,
+            {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+            {0, 0, 0},
+            {importer.size.width, importer.size.height, 1}};
+    cmd_buf->copyImageToBuffer(target.img.get(),
+                               vk::ImageLayout::eTransferSrcOptimal,
+                               importer.dst_buf.get(), region);
+    // Back to the producer in the layout it was handed over
+    const vk::ImageMemoryBarrier to_external = {
+            {},
+            {},
+            vk::ImageLayout::eTransferSrcOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            queue_family_idx,
+            VK_QUEUE_FAMILY_EXTERNAL,
+            target.img.get(),
+            {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}};
+    cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                             vk::PipelineStageFlagBits::eBottomOfPipe, {},
+                             nullptr, nullptr, to_external);
+    vkw::EndCommand(cmd_buf);
+
+    const vk::Semaphore wait_semaphore = target.ready_semaphore.get();
+    const vk::Semaphore signal_semaphore = target.release_semaphore.get();
+    const vk::PipelineStageFlags wait_stage =
+            vk::PipelineStageFlagBits::eTransfer;
+    const vk::CommandBuffer cmd_buf_raw = cmd_buf.get();
+    importer.device->resetFences(target.fence.get());
+    importer.queue.submit(vk::SubmitInfo(1, &wait_semaphore, &wait_stage, 1,
+                                         &cmd_buf_raw, 1, &signal_semaphore),
+                          target.fence.get());
+}
+
+void WaitImporter(const Importer& importer) {
+    for (auto&& target : importer.targets) {
+        WaitFence(importer.device, target.fence);
+    }
+}
+
+// Submits the producer's frame, which waits for the release of its target by
+// the importer and signals the semaphore of the target.
+// Returns false when only uploads are recorded (No target to composite).
+bool SubmitExportedFrame(const OffscreenEnv& env,
+                         const vk::UniqueCommandBuffer& cmd_buf,
+                         const vk::UniqueFence& fence, uint32_t& target_idx) {
+    const auto& submit = ImGui_ImplVulkanHpp_GetOffscreenSubmit();
+    const uint32_t n_waits = submit.wait_semaphore ? 1 : 0;
+    const uint32_t n_signals = submit.is_drawn ? 1 : 0;
+    const vk::CommandBuffer cmd_buf_raw = cmd_buf.get();
+    env.device->resetFences(fence.get());
+    env.queue.submit(vk::SubmitInfo(n_waits, &submit.wait_semaphore,
+                                    &submit.wait_stage, 1, &cmd_buf_raw,
+                                    n_signals, &submit.signal_semaphore),
+                     fence.get());
+    target_idx = submit.target_idx;
+    return submit.is_drawn;
+}
+
+// Renders one frame through an exported target and directly into the target
+// of `env`, and compares the pixels seen by the importer with the direct ones.
+// (Call when no frame is in flight)
+bool CheckImportedFrame(const OffscreenEnv& env, Importer& importer,
+                        int frame_idx, FILE* fp) {
+    ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+    ImGui::NewFrame();
+    DrawTestFrame("Exported", frame_idx, ImGui::GetIO().DisplaySize);
+    ImGui::Render();
+    ImDrawData* draw_data = ImGui::GetDrawData();
+    auto& cmd_buf = env.cmd_bufs_pack->cmd_bufs[0];
+
+    // Through the exported target and the importer's device
+    uint32_t target_idx = 0;
+    if (!ImGui_ImplVulkanHpp_RenderDrawDataOffscreen(draw_data, cmd_buf)) {
+        std::fprintf(fp, "Failed: check frame is not recorded\n");
+        return false;
+    }
+    const bool is_drawn =
+            SubmitExportedFrame(env, cmd_buf, env.fence, target_idx);
+    WaitFence(env.device, env.fence);
+    if (!is_drawn) {
+        std::fprintf(fp, "Failed: check frame is not drawn\n");
+        return false;
+    }
+    CompositeTarget(importer, target_idx, env.queue_family_idx);
+    WaitImporter(importer);
+    ImGui_ImplVulkanHpp_SetCompletedFrameIndex(
+            ImGui_ImplVulkanHpp_GetFrameIndex());
+
+    // Directly (Reference)
+    ImGui_ImplVulkanHpp_RenderDrawData(
+            draw_data, cmd_buf, env.dst_img_pack->view.get(),
+            env.dst_img_format, env.dst_img_size,
+            vk::ImageLayout::eTransferSrcOptimal);
+    SubmitAndWait(env);
+    const std::vector<uint8_t> direct_pixels = ReadDstImage(env);
+
+    const size_t row_bytes = importer.size.width * 4;
+    const size_t n_diffs =
+            CountPixelDiffs(importer.dst_p, row_bytes, direct_pixels.data(),
+                            row_bytes, importer.size);
+    std::fprintf(fp, "%s: %zu pixels of the imported frame differ from "
+                 "direct rendering\n",
+                 n_diffs ? "Failed" : "Passed", n_diffs);
+    return n_diffs == 0;
+}
+
+}  // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    using Clock = std::chrono::steady_clock;
+    auto to_us = [](const Clock::duration& d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    };
+
+    FrameArgs args;
+    if (!ParseFrameArgs(argc, argv, args)) {
+        PrintFrameUsage(argv[0], "write the last imported frame");
+        return 1;
+    }
+    const vk::Extent2D size = {args.width, args.height};
+    const uint32_t N_TARGETS = 2;
+
+    // Producer (Device with external memory extensions. Its own target is the
+    // reference of the end-to-end check)
+    auto env = CreateOffscreenEnv("ImGui-VulkanHpp Export", size, args.debug,
+                                  EXTERNAL_EXTS);
+    const std::string device_name = GetDeviceName(env);
+
+    // Importer (Another logical device on the same physical device)
+    Importer importer;
+    importer.device = CreateDeviceWithExts(
+            env.physical_device, env.queue_family_idx, EXTERNAL_EXTS);
+    importer.queue = importer.device->getQueue(env.queue_family_idx, 0);
+    importer.cmd_bufs_pack = vkw::CreateCommandBuffersPack(
+            importer.device, env.queue_family_idx, N_TARGETS);
+    importer.size = size;
+    CreateImporterBuffer(env.physical_device, importer);
+
+    FILE* json_fp = nullptr;
+    if (!OpenJsonOutput(args.json_path, json_fp)) {
+        std::cerr << "Failed to open " << args.json_path << std::endl;
+        return 1;
+    }
+    FILE* text_fp = (json_fp == stdout) ? stderr : stdout;
+    std::fprintf(text_fp, "Device: %s\n", device_name.c_str());
+
+    // Initialize ImGui
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = {static_cast<float>(size.width),
+                      static_cast<float>(size.height)};
+    io.DeltaTime = 1.f / 60.f;
+    ImGui_ImplVulkanHpp_Init();
+    ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+
+    // Exportable targets, imported once
+    ImGui_ImplVulkanHpp_OffscreenDesc desc;
+    desc.size = size;
+    desc.n_targets = N_TARGETS;
+    desc.exportable = true;
+    desc.queue_family_idx = env.queue_family_idx;
+    ImGui_ImplVulkanHpp_CreateOffscreenTargets(desc);
+    for (uint32_t i = 0; i < N_TARGETS; i++) {
+        ImGui_ImplVulkanHpp_ExportedTarget exported;
+        if (!ImGui_ImplVulkanHpp_ExportTarget(i, exported)) {
+            std::cerr << "Failed to export target " << i << std::endl;
+            return 1;
+        }
+        importer.targets.push_back(
+                ImportTarget(env.physical_device, importer.device, exported));
+    }
+
+    // Producer's command buffer and fence for each frame in flight
+    auto cmd_bufs_pack = vkw::CreateCommandBuffersPack(
+            env.device, env.queue_family_idx, N_TARGETS);
+    std::vector<vk::UniqueFence> fences;
+    for (uint32_t i = 0; i < N_TARGETS; i++) {
+        fences.push_back(vkw::CreateFence(env.device));
+    }
+    std::vector<uint64_t> submitted_idxs(N_TARGETS, 0);  // 0: Idle
+
+    Samples samples;
+    uint64_t completed_idx = 0;
+    const int n_total = args.n_warmup + args.n_frames;
+    for (int i = 0; i < n_total; i++) {
+        // Reuse the command buffer of `N_TARGETS` frames ago. (The GPU waits
+        // for the importer's release, but the CPU never waits for the
+        // importer)
+        const uint32_t cmd_idx = static_cast<uint32_t>(i) % N_TARGETS;
+        if (submitted_idxs[cmd_idx] != 0) {
+            WaitFence(env.device, fences[cmd_idx]);
+            completed_idx = std::max(completed_idx, submitted_idxs[cmd_idx]);
+            submitted_idxs[cmd_idx] = 0;
+        }
+        ImGui_ImplVulkanHpp_SetCompletedFrameIndex(completed_idx);
+
+        ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+        ImGui::NewFrame();
+        DrawTestFrame("Exported", i, io.DisplaySize);
+        ImGui::Render();
+        ImDrawData* draw_data = ImGui::GetDrawData();
+
+        auto& cmd_buf = cmd_bufs_pack->cmd_bufs[cmd_idx];
+        const auto rec_start = Clock::now();
+        if (!ImGui_ImplVulkanHpp_RenderDrawDataOffscreen(draw_data, cmd_buf)) {
+            continue;
+        }
+        const auto rec_end = Clock::now();
+
+        // Producer signals the semaphore of the target
+        uint32_t target_idx = 0;
+        const bool is_drawn = SubmitExportedFrame(env, cmd_buf,
+                                                  fences[cmd_idx], target_idx);
+        submitted_idxs[cmd_idx] = ImGui_ImplVulkanHpp_GetFrameIndex();
+        if (!is_drawn) {
+            continue;
+        }
+
+        // Importer waits for it on its own queue (No CPU copy in between, and
+        // no wait for the copy, which overlaps the next producer's frame)
+        CompositeTarget(importer, target_idx, env.queue_family_idx);
+        const auto composite_end = Clock::now();
+
+        if (args.n_warmup <= i) {
+            AddFrameSamples(samples, draw_data, rec_end - rec_start,
+                            composite_end - rec_end);
+            samples.add("export_to_composite_us",
+                        to_us(composite_end - rec_end));
+        }
+    }
+
+    PrintText(text_fp, "export", samples);
+    if (json_fp) {
+        PrintJson(json_fp, device_name, "export", size.width, size.height,
+                  args.n_frames, samples);
+    }
+    CloseJsonOutput(json_fp);
+
+    // Everything is completed after the idle waits
+    env.device->waitIdle();
+    WaitImporter(importer);
+    ImGui_ImplVulkanHpp_SetCompletedFrameIndex(
+            ImGui_ImplVulkanHpp_GetFrameIndex());
+    if (!args.ppm_path.empty() &&
+        !WritePpm(args.ppm_path, importer.dst_p, size, size.width * 4)) {
+        std::cerr << "Failed to write " << args.ppm_path << std::endl;
+    }
+
+    // End-to-end check
+    const bool is_passed = CheckImportedFrame(env, importer, n_total, text_fp);
+
+    // Clean up
+    env.device->waitIdle();
+    importer.device->waitIdle();
+    ImGui_ImplVulkanHpp_Shutdown();
+    ImGui::DestroyContext();
+
+    return is_passed ? 0 : 1;
+}
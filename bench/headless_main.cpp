@@ -0,0 +1,286 @@
+#include <vkw/warning_suppressor.h>
+
+BEGIN_VKW_SUPPRESS_WARNING
+#include <imgui.h>
+#include <imgui_impl_vulkanhpp.h>
+END_VKW_SUPPRESS_WARNING
+
+#include <vkw/vkw.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench_utils.h"
+#include "offscreen.h"
+
+namespace {
+
+struct Args {
+    FrameArgs common;
+    uint32_t n_targets = 3;
+};
+
+void PrintUsage(const char* prog) {
+    PrintFrameUsage(prog, "write the last completed frame");
+    std::cerr << "  --targets N       offscreen targets in the ring "
+                 "(default: 3)"
+              << std::endl;
+}
+
+bool ParseArgs(int argc, char const* argv[], Args& args) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--targets" && i + 1 < argc) {
+            args.n_targets =
+                    static_cast<uint32_t>(std::max(2, std::atoi(argv[++i])));
+        } else if (!ParseFrameArg(argc, argv, i, args.common)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sum of all bytes (Touches the whole frame like a real consumer)
+uint64_t ComputeChecksum(const ImGui_ImplVulkanHpp_ReadbackFrame& frame) {
+    uint64_t sum = 0;
+    const size_t n_bytes = frame.row_bytes * frame.size.height;
+    for (size_t i = 0; i < n_bytes; i++) {
+        sum += frame.pixels[i];
+    }
+    return sum;
+}
+
+// Records the first frame with empty draw data. Its command buffer still
+// carries the font upload, so it must be submitted without taking a target.
+// (Call before any other frame)
+bool CheckEmptyFirstFrame(const OffscreenEnv& env, FILE* fp) {
+    ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+    ImGui::NewFrame();
+    ImGui::Render();
+    ImDrawData* draw_data = ImGui::GetDrawData();
+    auto& cmd_buf = env.cmd_bufs_pack->cmd_bufs[0];
+
+    if (!ImGui_ImplVulkanHpp_RenderDrawDataOffscreen(draw_data, cmd_buf)) {
+        std::fprintf(fp, "Failed: empty first frame is not recorded\n");
+        return false;
+    }
+    SubmitAndWait(env);
+    ImGui_ImplVulkanHpp_SetCompletedFrameIndex(
+            ImGui_ImplVulkanHpp_GetFrameIndex());
+    ImGui_ImplVulkanHpp_ReadbackFrame frame;
+    const bool is_passed =
+            !ImGui_ImplVulkanHpp_GetOffscreenSubmit().is_drawn &&
+            !ImGui_ImplVulkanHpp_GetReadbackFrame(frame);
+    std::fprintf(fp, "%s: empty first frame %s a target\n",
+                 is_passed ? "Passed" : "Failed",
+                 is_passed ? "takes no" : "takes");
+    return is_passed;
+}
+
+// Renders one frame through the ring and directly into the target of `env`,
+// and compares their pixels. (Call when no frame is in flight)
+bool CheckRingFrame(const OffscreenEnv& env, int frame_idx, FILE* fp) {
+    ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+    ImGui::NewFrame();
+    DrawTestFrame("Headless", frame_idx, ImGui::GetIO().DisplaySize);
+    ImGui::Render();
+    ImDrawData* draw_data = ImGui::GetDrawData();
+    auto& cmd_buf = env.cmd_bufs_pack->cmd_bufs[0];
+
+    // Through the ring and its readback buffer
+    if (!ImGui_ImplVulkanHpp_RenderDrawDataOffscreen(draw_data, cmd_buf)) {
+        std::fprintf(fp, "Failed: check frame is not recorded\n");
+        return false;
+    }
+    SubmitAndWait(env);
+    const uint64_t ring_frame_idx = ImGui_ImplVulkanHpp_GetFrameIndex();
+    ImGui_ImplVulkanHpp_SetCompletedFrameIndex(ring_frame_idx);
+    ImGui_ImplVulkanHpp_ReadbackFrame frame;
+    if (!ImGui_ImplVulkanHpp_GetReadbackFrame(frame) ||
+        frame.frame_idx != ring_frame_idx || frame.size != env.dst_img_size) {
+        std::fprintf(fp, "Failed: check frame is not read back\n");
+        return false;
+    }
+    const std::vector<uint8_t> ring_pixels(
+            frame.pixels, frame.pixels + frame.row_bytes * frame.size.height);
+
+    // Directly (Reference)
+    ImGui_ImplVulkanHpp_RenderDrawData(
+            draw_data, cmd_buf, env.dst_img_pack->view.get(),
+            env.dst_img_format, env.dst_img_size,
+            vk::ImageLayout::eTransferSrcOptimal);
+    SubmitAndWait(env);
+    ImGui_ImplVulkanHpp_SetCompletedFrameIndex(
+            ImGui_ImplVulkanHpp_GetFrameIndex());
+    const std::vector<uint8_t> direct_pixels = ReadDstImage(env);
+
+    const size_t n_diffs = CountPixelDiffs(
+            ring_pixels.data(), frame.row_bytes, direct_pixels.data(),
+            env.dst_img_size.width * 4, env.dst_img_size);
+    std::fprintf(fp, "%s: %zu pixels of the ring frame differ from direct "
+                 "rendering\n",
+                 n_diffs ? "Failed" : "Passed", n_diffs);
+    return n_diffs == 0;
+}
+
+}  // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    using Clock = std::chrono::steady_clock;
+    auto to_us = [](const Clock::duration& d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    };
+
+    Args args;
+    if (!ParseArgs(argc, argv, args)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    const vk::Extent2D size = {args.common.width, args.common.height};
+
+    // Initialize headless Vulkan (The ring is owned by the backend, and the
+    // target of `env` is the reference of the end-to-end check)
+    auto env = CreateOffscreenEnv("ImGui-VulkanHpp Headless", size,
+                                  args.common.debug);
+    const std::string device_name = GetDeviceName(env);
+
+    FILE* json_fp = nullptr;
+    if (!OpenJsonOutput(args.common.json_path, json_fp)) {
+        std::cerr << "Failed to open " << args.common.json_path << std::endl;
+        return 1;
+    }
+    FILE* text_fp = (json_fp == stdout) ? stderr : stdout;
+    std::fprintf(text_fp, "Device: %s\n", device_name.c_str());
+
+    // Command buffer and fence for each frame in flight
+    auto cmd_bufs_pack = vkw::CreateCommandBuffersPack(
+            env.device, env.queue_family_idx, args.n_targets);
+    std::vector<vk::UniqueFence> fences;
+    for (uint32_t i = 0; i < args.n_targets; i++) {
+        fences.push_back(vkw::CreateFence(env.device));
+    }
+    std::vector<uint64_t> submitted_idxs(args.n_targets, 0);  // 0: Idle
+    uint32_t cmd_idx = 0;
+
+    // Initialize ImGui
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = {static_cast<float>(size.width),
+                      static_cast<float>(size.height)};
+    io.DeltaTime = 1.f / 60.f;
+    ImGui_ImplVulkanHpp_Init();
+    ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+    ImGui_ImplVulkanHpp_OffscreenDesc desc;
+    desc.size = size;
+    desc.n_targets = args.n_targets;
+    ImGui_ImplVulkanHpp_CreateOffscreenTargets(desc);
+
+    // Font upload without drawing (Later frames sample the font)
+    bool is_passed = CheckEmptyFirstFrame(env, text_fp);
+
+    Samples samples;
+    uint64_t completed_idx = 0;
+    uint64_t total_checksum = 0;
+    const int n_total = args.common.n_warmup + args.common.n_frames;
+    for (int i = 0; i < n_total; i++) {
+        // Poll completion without waiting
+        for (uint32_t j = 0; j < args.n_targets; j++) {
+            if (submitted_idxs[j] != 0 &&
+                env.device->getFenceStatus(fences[j].get()) ==
+                        vk::Result::eSuccess) {
+                completed_idx = std::max(completed_idx, submitted_idxs[j]);
+                submitted_idxs[j] = 0;
+            }
+        }
+        ImGui_ImplVulkanHpp_SetCompletedFrameIndex(completed_idx);
+
+        ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+        ImGui::NewFrame();
+        DrawTestFrame("Headless", i, io.DisplaySize);
+        ImGui::Render();
+        ImDrawData* draw_data = ImGui::GetDrawData();
+
+        // Record and submit (Dropped while the command buffer is in flight)
+        auto& cmd_buf = cmd_bufs_pack->cmd_bufs[cmd_idx];
+        const auto rec_start = Clock::now();
+        const bool is_recorded =
+                submitted_idxs[cmd_idx] == 0 &&
+                ImGui_ImplVulkanHpp_RenderDrawDataOffscreen(draw_data, cmd_buf);
+        const auto rec_end = Clock::now();
+        if (is_recorded) {
+            const vk::CommandBuffer cmd_buf_raw = cmd_buf.get();
+            const vk::Fence fence = fences[cmd_idx].get();
+            env.device->resetFences(fence);
+            env.queue.submit(vk::SubmitInfo(0, nullptr, nullptr, 1,
+                                            &cmd_buf_raw),
+                             fence);
+            submitted_idxs[cmd_idx] = ImGui_ImplVulkanHpp_GetFrameIndex();
+            cmd_idx = (cmd_idx + 1) % args.n_targets;
+        }
+        const auto submit_end = Clock::now();
+
+        // Consume the newest completed frame
+        ImGui_ImplVulkanHpp_ReadbackFrame frame;
+        const bool has_frame = ImGui_ImplVulkanHpp_GetReadbackFrame(frame);
+        if (has_frame) {
+            total_checksum += ComputeChecksum(frame);
+        }
+        const auto read_end = Clock::now();
+
+        if (args.common.n_warmup <= i) {
+            samples.add("dropped_frames", is_recorded ? 0.0 : 1.0);
+            if (is_recorded) {
+                AddFrameSamples(samples, draw_data, rec_end - rec_start,
+                                submit_end - rec_end);
+            }
+            if (has_frame) {
+                const uint64_t lag =
+                        ImGui_ImplVulkanHpp_GetFrameIndex() - frame.frame_idx;
+                samples.add("readback_lag_frames", static_cast<double>(lag));
+                samples.add("readback_us", to_us(read_end - submit_end));
+            }
+        }
+    }
+
+    PrintText(text_fp, "headless", samples);
+    std::fprintf(text_fp, "Checksum: %llu\n",
+                 static_cast<unsigned long long>(total_checksum));
+    if (json_fp) {
+        PrintJson(json_fp, device_name, "headless", size.width, size.height,
+                  args.common.n_frames, samples);
+    }
+    CloseJsonOutput(json_fp);
+
+    // Everything is completed after the idle wait
+    env.device->waitIdle();
+    ImGui_ImplVulkanHpp_SetCompletedFrameIndex(
+            ImGui_ImplVulkanHpp_GetFrameIndex());
+    if (!args.common.ppm_path.empty()) {
+        ImGui_ImplVulkanHpp_ReadbackFrame frame;
+        if (!ImGui_ImplVulkanHpp_GetReadbackFrame(frame) ||
+            !WritePpm(args.common.ppm_path, frame.pixels, frame.size,
+                      frame.row_bytes)) {
+            std::cerr << "Failed to write " << args.common.ppm_path
+                      << std::endl;
+        }
+    }
+
+    // End-to-end check
+    is_passed = CheckRingFrame(env, n_total, text_fp) && is_passed;
+
+    // Clean up
+    ImGui_ImplVulkanHpp_Shutdown();
+    ImGui::DestroyContext();
+
+    return is_passed ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+#ifndef OFFSCREEN_H_20261018
+#define OFFSCREEN_H_20261018
+
+#include <vkw/vkw.h>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// ---------------------- Headless Vulkan Environment --------------------------
+// -----------------------------------------------------------------------------
+// Device and render target without any window or surface.
+// (Works on software implementations such as lavapipe)
+struct OffscreenEnv {
+    vk::UniqueInstance instance;
+    vk::PhysicalDevice physical_device;
+    uint32_t queue_family_idx = 0;
+    vk::UniqueDevice device;
+    vk::Queue queue;
+
+    vk::Format dst_img_format = vk::Format::eR8G8B8A8Unorm;
+    vk::Extent2D dst_img_size;
+    vkw::ImagePackPtr dst_img_pack;
+
+    vkw::CommandBuffersPackPtr cmd_bufs_pack;
+    vk::UniqueFence fence;
+};
+
+inline uint32_t GetGraphicQueueFamilyIdx(
+        const vk::PhysicalDevice& physical_device) {
+    const auto& props = physical_device.getQueueFamilyProperties();
+    for (uint32_t i = 0; i < props.size(); i++) {
+        if (props[i].queueFlags & vk::QueueFlagBits::eGraphics) {
+            return i;
+        }
+    }
+    throw std::runtime_error("No graphic queue family");
+}
+
+// Device with extra extensions, which `vkw::CreateDevice` does not take.
+// Its functions are dispatched through the instance, so that several devices
+// can share the default dispatcher.
+inline vk::UniqueDevice CreateDeviceWithExts(
+        const vk::PhysicalDevice& physical_device, uint32_t queue_family_idx,
+        const std::vector<const char*>& exts) {
+    const float priority = 1.f;
+    const vk::DeviceQueueCreateInfo queue_info = {
+            {}, queue_family_idx, 1, &priority};
+    const vk::DeviceCreateInfo device_info = {
+            {}, 1, &queue_info, 0, nullptr,
+            static_cast<uint32_t>(exts.size()), exts.data()};
+    return physical_device.createDeviceUnique(device_info);
+}
+
+inline OffscreenEnv CreateOffscreenEnv(
+        const std::string& app_name, const vk::Extent2D& dst_img_size,
+        bool debug_enable = false,
+        const std::vector<const char*>& device_exts = {}) {
+    const bool DISPLAY_ENABLE = false;
+    const uint32_t N_QUEUES = 1;
+
+    OffscreenEnv env;
+    // Create instance
+    env.instance = vkw::CreateInstance(app_name, 1, "ImGui-VulkanHpp", 0,
+                                       debug_enable, DISPLAY_ENABLE);
+    // Get a physical_device
+    env.physical_device = vkw::GetFirstPhysicalDevice(env.instance);
+    // Select queue family
+    env.queue_family_idx = GetGraphicQueueFamilyIdx(env.physical_device);
+    // Create device
+    if (device_exts.empty()) {
+        env.device = vkw::CreateDevice(env.queue_family_idx,
+                                       env.physical_device, N_QUEUES,
+                                       DISPLAY_ENABLE);
+    } else {
+        env.device = CreateDeviceWithExts(env.physical_device,
+                                          env.queue_family_idx, device_exts);
+    }
+    // Get queues
+    env.queue = vkw::GetQueues(env.device, env.queue_family_idx, N_QUEUES)[0];
+
+    // Render target (Instead of swapchain image)
+    env.dst_img_size = dst_img_size;
+    env.dst_img_pack = vkw::CreateImagePack(
+            env.physical_device, env.device, env.dst_img_format, dst_img_size,
+            1,
+            vk::ImageUsageFlagBits::eColorAttachment |
+                    vk::ImageUsageFlagBits::eSampled |
+                    vk::ImageUsageFlagBits::eTransferSrc |
+                    vk::ImageUsageFlagBits::eTransferDst,
+            {},
+            true,  // tiling
+            vk::ImageAspectFlagBits::eColor);
+
+    // Command buffer and its fence
+    env.cmd_bufs_pack = vkw::CreateCommandBuffersPack(
+            env.device, env.queue_family_idx, 1);
+    env.fence = vkw::CreateFence(env.device);
+
+    return env;
+}
+
+inline std::string GetDeviceName(const OffscreenEnv& env) {
+    return env.physical_device.getProperties().deviceName;
+}
+
+// Submit the command buffer and wait for its completion
+inline void SubmitAndWait(const OffscreenEnv& env) {
+    const vk::CommandBuffer cmd_buf = env.cmd_bufs_pack->cmd_bufs[0].get();
+    env.device->resetFences(env.fence.get());
+    env.queue.submit(vk::SubmitInfo(0, nullptr, nullptr, 1, &cmd_buf),
+                     env.fence.get());
+    const auto ret = env.device->waitForFences(env.fence.get(), VK_TRUE,
+                                               UINT64_MAX);
+    if (ret != vk::Result::eSuccess) {
+        throw std::runtime_error("Failed to wait for fence");
+    }
+}
+
+// Copies the render target (In `eTransferSrcOptimal` layout) to host memory
+// (Tightly packed rows)
+inline std::vector<uint8_t> ReadDstImage(const OffscreenEnv& env) {
+    const size_t n_bytes = static_cast<size_t>(env.dst_img_size.width) *
+                           env.dst_img_size.height * 4;
+    auto buf_pack = vkw::CreateBufferPack(
+            env.physical_device, env.device, n_bytes,
+            vk::BufferUsageFlagBits::eTransferDst, vkw::HOST_VISIB_COHER_PROPS);
+
+    auto& cmd_buf = env.cmd_bufs_pack->cmd_bufs[0];
+    vkw::ResetCommand(cmd_buf);
+    vkw::BeginCommand(cmd_buf, true);
+    const vk::BufferImageCopy region = {
+            0,
+            0,
+            0,
+            {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+            {0, 0, 0},
+            {env.dst_img_size.width, env.dst_img_size.height, 1}};
+    cmd_buf->copyImageToBuffer(env.dst_img_pack->img.get(),
+                               vk::ImageLayout::eTransferSrcOptimal,
+                               buf_pack->buf.get(), region);
+    vkw::EndCommand(cmd_buf);
+    SubmitAndWait(env);
+
+    std::vector<uint8_t> pixels(n_bytes);
+    vkw::RecvFromDevice(env.device, buf_pack, pixels.data(), n_bytes);
+    return pixels;
+}
+
+// Background image of the target size filled with a color
+// (Left in `eShaderReadOnlyOptimal` layout)
+inline vkw::ImagePackPtr CreateBgImage(const OffscreenEnv& env) {
+    auto bg_img_pack = vkw::CreateImagePack(
+            env.physical_device, env.device, env.dst_img_format,
+            env.dst_img_size, 1,
+            vk::ImageUsageFlagBits::eSampled |
+                    vk::ImageUsageFlagBits::eTransferSrc |
+                    vk::ImageUsageFlagBits::eTransferDst,
+            {},
+            true,  // tiling
+            vk::ImageAspectFlagBits::eColor);
+    const vk::Image img = bg_img_pack->img.get();
+    const vk::ImageSubresourceRange subres_range = {
+            vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+
+    auto& cmd_buf = env.cmd_bufs_pack->cmd_bufs[0];
+    vkw::ResetCommand(cmd_buf);
+    vkw::BeginCommand(cmd_buf, true);
+    const vk::ImageMemoryBarrier to_transfer = {
+            {},
+            vk::AccessFlagBits::eTransferWrite,
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eTransferDstOptimal,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            img,
+            subres_range};
+    cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                             vk::PipelineStageFlagBits::eTransfer, {}, nullptr,
+                             nullptr, to_transfer);
+    const vk::ClearColorValue color(
+            std::array<float, 4>{{0.2f, 0.3f, 0.4f, 1.f}});
+    cmd_buf->clearColorImage(img, vk::ImageLayout::eTransferDstOptimal, color,
+                             subres_range);
+    const vk::ImageMemoryBarrier to_shader = {
+            vk::AccessFlagBits::eTransferWrite,
+            vk::AccessFlagBits::eShaderRead,
+            vk::ImageLayout::eTransferDstOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            img,
+            subres_range};
+    cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                             vk::PipelineStageFlagBits::eAllCommands, {},
+                             nullptr, nullptr, to_shader);
+    vkw::EndCommand(cmd_buf);
+    SubmitAndWait(env);
+    return bg_img_pack;
+}
+
+#endif /* end of include guard */
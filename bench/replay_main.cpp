@@ -0,0 +1,102 @@
+#include <vkw/warning_suppressor.h>
+
+BEGIN_VKW_SUPPRESS_WARNING
+#include <imgui.h>
+#include <imgui_impl_vulkanhpp.h>
+#include <imgui_impl_vulkanhpp_capture.h>
+END_VKW_SUPPRESS_WARNING
+
+#include <vkw/vkw.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "bench_utils.h"
+#include "offscreen.h"
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    using Clock = std::chrono::steady_clock;
+
+    ReplayArgs args;
+    if (!ParseReplayArgs(argc, argv, args)) {
+        PrintReplayUsage(argv[0]);
+        return 1;
+    }
+
+    // Open capture
+    int n_frames = 0;
+    vk::Extent2D size;
+    auto replay = OpenReplayCapture(args.capture_path, n_frames, size);
+    if (!replay) {
+        return 1;
+    }
+
+    // Initialize headless Vulkan
+    auto env = CreateOffscreenEnv("ImGui-VulkanHpp Replay", size, args.debug);
+    const std::string device_name = GetDeviceName(env);
+
+    FILE* json_fp = nullptr;
+    if (!OpenJsonOutput(args.json_path, json_fp)) {
+        std::cerr << "Failed to open " << args.json_path << std::endl;
+        ImGui_ImplVulkanHpp_CloseReplay(replay);
+        return 1;
+    }
+    FILE* text_fp = (json_fp == stdout) ? stderr : stdout;
+    std::fprintf(text_fp, "Device: %s\n", device_name.c_str());
+    std::fprintf(text_fp, "Capture: %s (%d frames, %ux%u)\n",
+                 args.capture_path.c_str(), n_frames, size.width, size.height);
+
+    // ImGui context is needed only for the font atlas
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    ImGui_ImplVulkanHpp_Init();
+    ImGui_ImplVulkanHpp_NewFrame(env.physical_device, env.device);
+
+    // Replay frame by frame
+    Samples samples;
+    auto& cmd_buf = env.cmd_bufs_pack->cmd_bufs[0];
+    const int n_total = args.n_warmup + n_frames * args.n_loops;
+    for (int i = 0; i < n_total; i++) {
+        ImDrawData* draw_data = ImGui_ImplVulkanHpp_GetReplayFrame(
+                replay, i % n_frames, io.Fonts->TexID);
+
+        const auto rec_start = Clock::now();
+        ImGui_ImplVulkanHpp_RenderDrawData(
+                draw_data, cmd_buf, env.dst_img_pack->view.get(),
+                env.dst_img_format, env.dst_img_size,
+                vk::ImageLayout::eTransferSrcOptimal);
+        const auto rec_end = Clock::now();
+
+        SubmitAndWait(env);
+        const auto exec_end = Clock::now();
+
+        if (args.n_warmup <= i) {
+            AddFrameSamples(samples, draw_data, rec_end - rec_start,
+                            exec_end - rec_end);
+        }
+    }
+
+    PrintText(text_fp, "replay", samples);
+    if (json_fp) {
+        PrintJson(json_fp, device_name, args.capture_path, size.width,
+                  size.height, n_total - args.n_warmup, samples);
+    }
+    CloseJsonOutput(json_fp);
+
+    // Clean up
+    env.device->waitIdle();
+    ImGui_ImplVulkanHpp_Shutdown();
+    ImGui::DestroyContext();
+    ImGui_ImplVulkanHpp_CloseReplay(replay);
+
+    return 0;
+}
@@ -4,6 +4,7 @@ BEGIN_VKW_SUPPRESS_WARNING
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_vulkanhpp.h>
+#include <imgui_impl_vulkanhpp_pacer.h>
 
 #include <glm/geometric.hpp>
 #include <glm/glm.hpp>
@@ -13,8 +14,10 @@ END_VKW_SUPPRESS_WARNING
 
 #include <vkw/vkw.h>
 
+#include <array>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "cube.h"
 
@@ -92,6 +95,116 @@ private:
     glm::mat4 m_rot_mat = glm::mat4(1.f);
 };
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+namespace {
+
+void RecordCube(const vk::UniqueCommandBuffer& cmd_buf,
+                const vkw::RenderPassPackPtr& render_pass_pack,
+                const vkw::FrameBufferPackPtr& frame_buffer_pack,
+                const vkw::PipelinePackPtr& pipeline_pack,
+                const vkw::DescSetPackPtr& desc_set_pack,
+                const vkw::BufferPackPtr& vertex_buf_pack,
+                const vk::Extent2D& size) {
+    vkw::ResetCommand(cmd_buf);
+    vkw::BeginCommand(cmd_buf, true);
+
+    const std::array<float, 4> clear_color = {0.2f, 0.2f, 0.2f, 1.0f};
+    vkw::CmdBeginRenderPass(cmd_buf, render_pass_pack, frame_buffer_pack,
+                            {vk::ClearColorValue(clear_color),
+                             vk::ClearDepthStencilValue(1.f, 0)});
+    vkw::CmdBindPipeline(cmd_buf, pipeline_pack);
+
+    const std::vector<uint32_t> dynamic_offsets = {0};
+    vkw::CmdBindDescSets(cmd_buf, pipeline_pack, {desc_set_pack},
+                         dynamic_offsets);
+
+    vkw::CmdBindVertexBuffers(cmd_buf, 0, {vertex_buf_pack});
+
+    vkw::CmdSetViewport(cmd_buf, size);
+    vkw::CmdSetScissor(cmd_buf, size);
+
+    vkw::CmdDraw(cmd_buf, static_cast<uint32_t>(CUBE_VERTICES.size()));
+
+    vkw::CmdEndRenderPass(cmd_buf);
+    vkw::EndCommand(cmd_buf);
+}
+
+// Objects depending on the window size
+struct SwapchainObjects {
+    vkw::SwapchainPackPtr swapchain_pack;
+    // Cube targets for each frame in flight (Overlapping frames write them,
+    // and color is read as BG)
+    std::vector<vkw::ImagePackPtr> color_img_packs;
+    std::vector<vkw::ImagePackPtr> depth_img_packs;
+    std::vector<vkw::FrameBufferPackPtr> frame_buffer_packs;
+    // Semaphores waited by present, one per swapchain image. (The fence of a
+    // frame slot does not cover the present, but an image is acquired again
+    // only after its previous present)
+    std::vector<vk::UniqueSemaphore> present_semaphores;
+};
+
+// Blocks while the window is minimized (No swapchain has zero size)
+void WaitWindowVisible(GLFWwindow* window) {
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    while ((width == 0 || height == 0) && !glfwWindowShouldClose(window)) {
+        glfwWaitEvents();
+        glfwGetFramebufferSize(window, &width, &height);
+    }
+}
+
+// (Re)creates for the current window size. Old objects must not be in use.
+void UpdateSwapchainObjects(SwapchainObjects& objs,
+                            const vk::PhysicalDevice& physical_device,
+                            const vk::UniqueDevice& device,
+                            const vk::UniqueSurfaceKHR& surface,
+                            const vk::Format& surface_format,
+                            const vk::PresentModeKHR& present_mode,
+                            const vk::Format& depth_format,
+                            const vkw::RenderPassPackPtr& render_pass_pack,
+                            uint32_t n_frames_in_flight) {
+    // New views may get the same handles (Targets and BG)
+    if (objs.swapchain_pack) {
+        for (auto&& img : objs.swapchain_pack->imgs) {
+            ImGui_ImplVulkanHpp_ForgetTarget(img->view.get());
+        }
+    }
+    for (auto&& color_img_pack : objs.color_img_packs) {
+        ImGui_ImplVulkanHpp_ForgetTarget(color_img_pack->view.get());
+    }
+    // Old swapchain is destroyed before the surface gets a new one
+    objs = {};
+
+    objs.swapchain_pack = vkw::CreateSwapchainPack(
+            physical_device, device, surface, surface_format,
+            vk::ImageUsageFlagBits::eColorAttachment, present_mode);
+    const vk::Extent2D& size = objs.swapchain_pack->size;
+    for (uint32_t i = 0; i < n_frames_in_flight; i++) {
+        objs.color_img_packs.push_back(vkw::CreateImagePack(
+                physical_device, device, surface_format, size, 1,
+                vk::ImageUsageFlagBits::eColorAttachment |
+                        vk::ImageUsageFlagBits::eSampled,
+                {},
+                true,  // tiling
+                vk::ImageAspectFlagBits::eColor));
+        objs.depth_img_packs.push_back(vkw::CreateImagePack(
+                physical_device, device, depth_format, size, 1,
+                vk::ImageUsageFlagBits::eDepthStencilAttachment, {},
+                true,  // tiling
+                vk::ImageAspectFlagBits::eDepth));
+        objs.frame_buffer_packs.push_back(vkw::CreateFrameBuffer(
+                device, render_pass_pack,
+                {objs.color_img_packs.back(), objs.depth_img_packs.back()}));
+    }
+    for (size_t i = 0; i < objs.swapchain_pack->imgs.size(); i++) {
+        objs.present_semaphores.push_back(device->createSemaphoreUnique({}));
+    }
+}
+
+}  // anonymous namespace
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
@@ -103,6 +216,7 @@ int main(int argc, char const* argv[]) {
     const bool DEBUG_ENABLE = true;
     const bool VSYNC_ENABLE = false;
     const uint32_t N_QUEUES = 1;
+    const uint32_t N_FRAMES_IN_FLIGHT = 2;
     const std::string TITLE_STR = "ImGui-VulkanHpp Example";
 
     // -------------------------------------------------------------------------
@@ -138,19 +252,22 @@ int main(int argc, char const* argv[]) {
             device, VERT_SOURCE, vk::ShaderStageFlagBits::eVertex);
     auto frag_shader_module_pack = glsl_compiler.compileFromString(
             device, FRAG_SOURCE, vk::ShaderStageFlagBits::eFragment);
-    // Uniform buffer
-    auto uniform_buf_pack = vkw::CreateBufferPack(
-            physical_device, device, sizeof(UniformBuffer),
-            vk::BufferUsageFlagBits::eUniformBuffer,
-            vkw::HOST_VISIB_COHER_PROPS);
-    // Descriptor set for Uniform buffer
-    auto desc_set_pack = vkw::CreateDescriptorSetPack(
-            device, {{vk::DescriptorType::eUniformBufferDynamic, 1,
-                      vk::ShaderStageFlagBits::eVertex}});
-    auto write_desc_set_pack = vkw::CreateWriteDescSetPack();
-    vkw::AddWriteDescSet(write_desc_set_pack, desc_set_pack, 0,
-                         {uniform_buf_pack});
-    vkw::UpdateDescriptorSets(device, write_desc_set_pack);
+    // Uniform buffer and its descriptor set for each frame in flight
+    std::vector<vkw::BufferPackPtr> uniform_buf_packs;
+    std::vector<vkw::DescSetPackPtr> desc_set_packs;
+    for (uint32_t i = 0; i < N_FRAMES_IN_FLIGHT; i++) {
+        uniform_buf_packs.push_back(vkw::CreateBufferPack(
+                physical_device, device, sizeof(UniformBuffer),
+                vk::BufferUsageFlagBits::eUniformBuffer,
+                vkw::HOST_VISIB_COHER_PROPS));
+        desc_set_packs.push_back(vkw::CreateDescriptorSetPack(
+                device, {{vk::DescriptorType::eUniformBufferDynamic, 1,
+                          vk::ShaderStageFlagBits::eVertex}}));
+        auto write_desc_set_pack = vkw::CreateWriteDescSetPack();
+        vkw::AddWriteDescSet(write_desc_set_pack, desc_set_packs.back(), 0,
+                             {uniform_buf_packs.back()});
+        vkw::UpdateDescriptorSets(device, write_desc_set_pack);
+    }
     // Render pass
     auto render_pass_pack = vkw::CreateRenderPassPack();
     vkw::AddAttachientDesc(
@@ -165,6 +282,9 @@ int main(int argc, char const* argv[]) {
     vkw::AddSubpassDesc(render_pass_pack, {},
                         {{0, vk::ImageLayout::eColorAttachmentOptimal}},
                         {1, vk::ImageLayout::eDepthStencilAttachmentOptimal});
+    // No external dependency: Both attachments are owned per frame in flight,
+    // whose fence has been waited. (ImGui reads color as BG after the cube's
+    // semaphore)
     vkw::UpdateRenderPass(device, render_pass_pack);
     // Pipeline
     vkw::PipelineInfo pipeline_info;
@@ -174,7 +294,7 @@ int main(int argc, char const* argv[]) {
             {{0, sizeof(Vertex), vk::VertexInputRate::eVertex}},
             {{0, 0, vk::Format::eR32G32B32A32Sfloat, 0},
              {1, 0, vk::Format::eR32G32B32A32Sfloat, 16}},
-            pipeline_info, {desc_set_pack}, render_pass_pack);
+            pipeline_info, {desc_set_packs[0]}, render_pass_pack);
     // Vertex buffer
     const size_t vertex_buf_size = CUBE_VERTICES.size() * sizeof(Vertex);
     auto vertex_buf_pack =
@@ -187,64 +307,13 @@ int main(int argc, char const* argv[]) {
     // -------------------------------------------------------------------------
     // ---------------------- Window Size Dynamic Objects ----------------------
     // -------------------------------------------------------------------------
-    // Create swapchain
+    // Swapchain, cube targets, frame buffers and present semaphores
     auto present_mode = VSYNC_ENABLE ? vk::PresentModeKHR::eFifo :
                                        vk::PresentModeKHR::eImmediate;
-    auto swapchain_pack = vkw::CreateSwapchainPack(
-            physical_device, device, surface, surface_format,
-            vk::ImageUsageFlagBits::eColorAttachment, present_mode);
-    // Depth buffer
-    auto depth_img_pack = vkw::CreateImagePack(
-            physical_device, device, DEPTH_FORMAT, swapchain_pack->size, 1,
-            vk::ImageUsageFlagBits::eDepthStencilAttachment, {},
-            true,  // tiling
-            vk::ImageAspectFlagBits::eDepth);
-    // Color buffer
-    auto color_img_pack = vkw::CreateImagePack(
-            physical_device, device, surface_format, swapchain_pack->size, 1,
-            vk::ImageUsageFlagBits::eColorAttachment |
-                    vk::ImageUsageFlagBits::eSampled,
-            {},
-            true,  // tiling
-            vk::ImageAspectFlagBits::eColor);
-    // Frame buffer
-    auto frame_buffer_pack = vkw::CreateFrameBuffer(
-            device, render_pass_pack, {color_img_pack, depth_img_pack});
-    // Command buffer
-    auto cube_cmd_bufs_pack =
-            vkw::CreateCommandBuffersPack(device, queue_family_idx, 1);
-    auto& cube_cmd_buf = cube_cmd_bufs_pack->cmd_bufs[0];
-    auto imgui_cmd_bufs_pack =
-            vkw::CreateCommandBuffersPack(device, queue_family_idx, 1);
-    auto& imgui_cmd_buf = imgui_cmd_bufs_pack->cmd_bufs[0];
-
-    // Record commands
-    {
-        auto& cmd_buf = cube_cmd_buf;
-        vkw::ResetCommand(cmd_buf);
-        vkw::BeginCommand(cmd_buf);
-
-        const std::array<float, 4> clear_color = {0.2f, 0.2f, 0.2f, 1.0f};
-        vkw::CmdBeginRenderPass(cmd_buf, render_pass_pack, frame_buffer_pack,
-                                {vk::ClearColorValue(clear_color),
-                                 vk::ClearDepthStencilValue(1.f, 0)});
-        vkw::CmdBindPipeline(cmd_buf, pipeline_pack);
-
-        const std::vector<uint32_t> dynamic_offsets = {0};
-        vkw::CmdBindDescSets(cmd_buf, pipeline_pack, {desc_set_pack},
-                             dynamic_offsets);
-
-        vkw::CmdBindVertexBuffers(cmd_buf, 0, {vertex_buf_pack});
-
-        vkw::CmdSetViewport(cmd_buf, swapchain_pack->size);
-        vkw::CmdSetScissor(cmd_buf, swapchain_pack->size);
-
-        vkw::CmdDraw(cmd_buf, static_cast<uint32_t>(CUBE_VERTICES.size()));
-
-        vkw::CmdEndRenderPass(cmd_buf);
-        vkw::EndCommand(cmd_buf);
-    }
-
+    SwapchainObjects sc_objs;
+    UpdateSwapchainObjects(sc_objs, physical_device, device, surface,
+                           surface_format, present_mode, DEPTH_FORMAT,
+                           render_pass_pack, N_FRAMES_IN_FLIGHT);
     // -------------------------------------------------------------------------
     // ----------------------- Setup Dear ImGui context ------------------------
     // -------------------------------------------------------------------------
@@ -261,29 +330,78 @@ int main(int argc, char const* argv[]) {
     // -------------------------------------------------------------------------
     // ------------------------------- Main Loop -------------------------------
     // -------------------------------------------------------------------------
+    // Frame pacing (Objects of each frame in flight are recycled)
+    ImGui_ImplVulkanHpp_FramePacerDesc pacer_desc;
+    pacer_desc.queue_family_idx = queue_family_idx;
+    pacer_desc.n_frames_in_flight = N_FRAMES_IN_FLIGHT;
+    pacer_desc.n_cmd_bufs = 2;    // Cube and ImGui
+    pacer_desc.n_semaphores = 2;  // Image acquired, cube drawn
+    auto pacer = ImGui_ImplVulkanHpp_CreateFramePacer(device, pacer_desc);
+
     RotatedMVPC mvpc_generator;
-    mvpc_generator.resize(swapchain_pack->size);
+    mvpc_generator.resize(sc_objs.swapchain_pack->size);
+    bool is_swapchain_stale = false;
     while (!glfwWindowShouldClose(window.get())) {
-        // Update uniform buffer
+        // Recreate for the new window size
+        if (is_swapchain_stale) {
+            WaitWindowVisible(window.get());
+            if (glfwWindowShouldClose(window.get())) {
+                break;
+            }
+            ImGui_ImplVulkanHpp_WaitPacedFramesIdle(pacer);
+            device->waitIdle();  // Presents may still wait on semaphores
+            UpdateSwapchainObjects(sc_objs, physical_device, device, surface,
+                                   surface_format, present_mode, DEPTH_FORMAT,
+                                   render_pass_pack, N_FRAMES_IN_FLIGHT);
+            mvpc_generator.resize(sc_objs.swapchain_pack->size);
+            is_swapchain_stale = false;
+        }
+
+        // Wait only for the frame which used the same objects
+        const auto& frame = ImGui_ImplVulkanHpp_BeginPacedFrame(pacer);
+        auto& cube_cmd_buf = frame.cmd_bufs[0];
+        auto& imgui_cmd_buf = frame.cmd_bufs[1];
+        const vk::Semaphore& img_acquired_semaphore = frame.semaphores[0];
+        const vk::Semaphore& draw_cube_semaphore = frame.semaphores[1];
+
+        // Update uniform buffer of this frame
         auto mvpc_mat = mvpc_generator.next();
-        vkw::SendToDevice(device, uniform_buf_pack, &mvpc_mat[0],
-                          sizeof(mvpc_mat));
-
-        // Acquire swapchain image
-        auto img_acquired_semaphore = vkw::CreateSemaphore(device);
-        uint32_t curr_img_idx = vkw::AcquireNextImage(
-                device, swapchain_pack, img_acquired_semaphore, nullptr);
+        vkw::SendToDevice(device, uniform_buf_packs[frame.slot_idx],
+                          &mvpc_mat[0], sizeof(mvpc_mat));
+
+        // Acquire swapchain image. When out of date, nothing is signaled, so
+        // the frame is skipped without ending it. (The slot is begun again)
+        const auto& swapchain_pack = sc_objs.swapchain_pack;
+        const vk::SwapchainKHR swapchain = swapchain_pack->swapchain.get();
+        uint32_t curr_img_idx = 0;
+        try {
+            const auto acquire_ret = device->acquireNextImageKHR(
+                    swapchain, UINT64_MAX, img_acquired_semaphore, nullptr);
+            curr_img_idx = acquire_ret.value;
+            // Suboptimal one is still presented (Recreated after the frame)
+            is_swapchain_stale =
+                    (acquire_ret.result == vk::Result::eSuboptimalKHR);
+        } catch (const vk::OutOfDateKHRError&) {
+            is_swapchain_stale = true;
+            continue;
+        }
         auto& swapchain_img = swapchain_pack->imgs[curr_img_idx];
-
-        // Submit
-        auto draw_cube_semaphore = vkw::CreateSemaphore(device);
-        auto draw_cube_fence = vkw::CreateFence(device);
-        vkw::QueueSubmit(queues[0], cube_cmd_buf, draw_cube_fence,
-                         {{img_acquired_semaphore,
-                           vk::PipelineStageFlagBits::eColorAttachmentOutput}},
-                         {draw_cube_semaphore});
-
-        vkw::WaitForFences(device, {draw_cube_fence});
+        const vk::Semaphore draw_imgui_semaphore =
+                sc_objs.present_semaphores[curr_img_idx].get();
+
+        // Record and submit cube
+        RecordCube(cube_cmd_buf, render_pass_pack,
+                   sc_objs.frame_buffer_packs[frame.slot_idx], pipeline_pack,
+                   desc_set_packs[frame.slot_idx], vertex_buf_pack,
+                   swapchain_pack->size);
+        const vk::PipelineStageFlags cube_wait_stage =
+                vk::PipelineStageFlagBits::eColorAttachmentOutput;
+        const vk::CommandBuffer cube_cmd_buf_raw = cube_cmd_buf.get();
+        queues[0].submit(vk::SubmitInfo(1, &img_acquired_semaphore,
+                                        &cube_wait_stage, 1,
+                                        &cube_cmd_buf_raw, 1,
+                                        &draw_cube_semaphore),
+                         nullptr);
 
         // New frame of ImGui
         ImGui_ImplVulkanHpp_NewFrame(physical_device, device);
@@ -291,33 +409,54 @@ int main(int argc, char const* argv[]) {
         ImGui::NewFrame();
         // Create ImGui window
         ImGui::ShowDemoWindow();
+        ImGui::Begin("Frame Pacing");
+        ImGui::Text("Frames in flight: %u", N_FRAMES_IN_FLIGHT);
+        ImGui::Text("CPU wait: %.1f us", static_cast<double>(frame.wait_us));
+        ImGui::End();
         // Render ImGui
         ImGui::Render();
         ImDrawData* draw_data = ImGui::GetDrawData();
         ImGui_ImplVulkanHpp_RenderDrawData(
                 draw_data, imgui_cmd_buf, swapchain_img->view.get(),
                 swapchain_img->view_format, swapchain_img->view_size,
-                vk::ImageLayout::ePresentSrcKHR, color_img_pack->view.get(),
+                vk::ImageLayout::ePresentSrcKHR,
+                sc_objs.color_img_packs[frame.slot_idx]->view.get(),
                 vk::ImageLayout::eShaderReadOnlyOptimal);
 
-        auto draw_imgui_semaphore = vkw::CreateSemaphore(device);
-        auto draw_imgui_fence = vkw::CreateFence(device);
-        vkw::QueueSubmit(queues[0], imgui_cmd_buf, draw_imgui_fence,
-                         {{draw_cube_semaphore,
-                           vk::PipelineStageFlagBits::eColorAttachmentOutput}},
-                         {draw_imgui_semaphore});
-
-        // Present
-        vkw::QueuePresent(queues[0], swapchain_pack, curr_img_idx,
-                          {draw_imgui_semaphore});
-        vkw::WaitForFences(device, {draw_imgui_fence});
+        // Submit ImGui after the cube, which is also sampled or copied as BG.
+        // Its fence completes the frame.
+        const vk::PipelineStageFlags imgui_wait_stage =
+                vk::PipelineStageFlagBits::eAllCommands;
+        const vk::CommandBuffer imgui_cmd_buf_raw = imgui_cmd_buf.get();
+        queues[0].submit(vk::SubmitInfo(1, &draw_cube_semaphore,
+                                        &imgui_wait_stage, 1,
+                                        &imgui_cmd_buf_raw, 1,
+                                        &draw_imgui_semaphore),
+                         frame.fence);
+        ImGui_ImplVulkanHpp_EndPacedFrame(pacer);
+
+        // Present (Without waiting for the GPU). Its semaphore wait is
+        // executed even when out of date.
+        try {
+            const vk::Result present_ret = queues[0].presentKHR(
+                    {1, &draw_imgui_semaphore, 1, &swapchain, &curr_img_idx});
+            if (present_ret == vk::Result::eSuboptimalKHR) {
+                is_swapchain_stale = true;
+            }
+        } catch (const vk::OutOfDateKHRError&) {
+            is_swapchain_stale = true;
+        }
 
         // Window update
         vkw::PrintFps();
         glfwPollEvents();
     }
 
+    // Presents are not covered by the pacer
+    device->waitIdle();
+
     // Clean up ImGui
+    ImGui_ImplVulkanHpp_DestroyFramePacer(pacer);
     ImGui_ImplVulkanHpp_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
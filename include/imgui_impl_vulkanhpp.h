@@ -5,8 +5,237 @@
 
 #include <vulkan/vulkan.hpp>
 
+// Vertex format in the device buffer
+enum class ImGui_ImplVulkanHpp_VertexFormat {
+    Float,    // `ImDrawVert` as is (20 bytes)
+    Compact,  // int16 positions in 1/4 pixels (within +-8191 px from
+              // `DisplayPos`), unorm16 UVs (within [0, 1]) and u32 color
+              // (12 bytes)
+};
+
+// Composition of the background image (See `ImGui_ImplVulkanHpp_SetBgImages`)
+enum class ImGui_ImplVulkanHpp_BgComposite {
+    Auto,    // Copy, blit or shader, whichever is possible first
+    Copy,    // vkCmdCopyImage (Same format and extent)
+    Blit,    // vkCmdBlitImage (Blittable formats, stretched)
+    Shader,  // Fullscreen sampling subpass (Always possible)
+};
+
+// Optional features (Set after `ImGui_ImplVulkanHpp_Init`)
+struct ImGui_ImplVulkanHpp_Options {
+    // Timestamp queries around BG and ImGui passes.
+    // (See `ImGui_ImplVulkanHpp_GetGpuTimings`)
+    bool gpu_timing = false;
+    // Quantizes vertices during the upload to reduce bandwidth. Frames with
+    // vertices out of the compact range are uploaded as `Float` instead.
+    ImGui_ImplVulkanHpp_VertexFormat vertex_format =
+            ImGui_ImplVulkanHpp_VertexFormat::Float;
+    // Reads vertices from a storage buffer instead of vertex input.
+    bool vertex_pulling = false;
+    // Compiles missing pipelines on a background thread. ImGui is skipped
+    // until they are ready (The background is still drawn), instead of
+    // stalling the render thread.
+    bool async_pipeline_build = false;
+    // Draws axis-aligned textured quads as instances (One 36-byte record
+    // per quad instead of 4 vertices and 6 indices).
+    bool instanced_quads = false;
+    // Preferred background composition. Falls back to the shader when it is
+    // impossible for the current images.
+    ImGui_ImplVulkanHpp_BgComposite bg_composite =
+            ImGui_ImplVulkanHpp_BgComposite::Auto;
+    // Renders ImGui into a backend-owned image of this scale (0, 1] of the
+    // destination, then upscales it with bilinear filtering. Trades sharpness
+    // for fill rate on high-resolution or software-rasterized targets.
+    float overlay_scale = 1.f;
+};
+
+// Images behind the views of the next `ImGui_ImplVulkanHpp_RenderDrawData`
+// call. Without them, the background is always composited by the shader.
+// (`bg_img` needs TRANSFER_SRC usage and `dst_img` needs TRANSFER_DST usage)
+struct ImGui_ImplVulkanHpp_BgImages {
+    vk::Image bg_img;
+    vk::Format bg_img_format = vk::Format::eUndefined;
+    vk::Extent2D bg_img_size;
+    vk::Image dst_img;
+};
+
+// Ring of backend-owned color targets for headless rendering
+// (See `ImGui_ImplVulkanHpp_CreateOffscreenTargets`)
+struct ImGui_ImplVulkanHpp_OffscreenDesc {
+    vk::Format format = vk::Format::eR8G8B8A8Unorm;
+    vk::Extent2D size;
+    uint32_t n_targets = 3;  // Frames in flight + 1 (At least 2)
+    // Allocates targets exportable as opaque fds to another process or device
+    // instead of reading them back. (Needs VK_KHR_external_memory_fd and
+    // VK_KHR_external_semaphore_fd. See `ImGui_ImplVulkanHpp_ExportTarget`)
+    bool exportable = false;
+    uint32_t queue_family_idx = 0;  // Rendering queue (Exportable only)
+};
+
+// Exported offscreen target (See `ImGui_ImplVulkanHpp_ExportTarget`).
+// The importer creates an image of the same parameters with optimal tiling,
+// binds it to the memory as a dedicated allocation, and imports the
+// semaphores. Each frame is left in SHADER_READ_ONLY_OPTIMAL layout and
+// released to VK_QUEUE_FAMILY_EXTERNAL. For each frame, the importer waits for
+// the ready semaphore, acquires the image, releases it back to
+// VK_QUEUE_FAMILY_EXTERNAL in SHADER_READ_ONLY_OPTIMAL layout when done, and
+// signals the release semaphore. The target is not rendered again before that.
+struct ImGui_ImplVulkanHpp_ExportedTarget {
+    int mem_fd = -1;  // Ownership is passed to the caller (or the importer)
+    vk::DeviceSize mem_size = 0;
+    int semaphore_fd = -1;  // Ready semaphore. Ownership is passed as well
+    int release_semaphore_fd = -1;  // Signaled by the importer. Passed as well
+    vk::Format format = vk::Format::eUndefined;
+    vk::Extent2D size;
+    vk::ImageUsageFlags usage;
+};
+
+// Target rendered by the last `ImGui_ImplVulkanHpp_RenderDrawDataOffscreen`
+struct ImGui_ImplVulkanHpp_OffscreenSubmit {
+    bool is_drawn = false;  // False: Only uploads are recorded (No target)
+    uint32_t target_idx = 0;
+    // Exportable only: Signal it in the submit of the frame. The importer must
+    // wait for it before the target comes around again. (Null if not drawn)
+    vk::Semaphore signal_semaphore;
+    // Exportable only: Wait for it in the submit at `wait_stage`, even if not
+    // drawn. It is the release of the importer's previous use of the target.
+    // (Null at the first use)
+    vk::Semaphore wait_semaphore;
+    vk::PipelineStageFlags wait_stage =
+            vk::PipelineStageFlagBits::eColorAttachmentOutput;
+};
+
+// Pixels of a completed offscreen frame in host memory (Tightly packed rows)
+struct ImGui_ImplVulkanHpp_ReadbackFrame {
+    const uint8_t* pixels = nullptr;
+    vk::Extent2D size;
+    vk::Format format = vk::Format::eUndefined;
+    size_t row_bytes = 0;
+    uint64_t frame_idx = 0;  // See `ImGui_ImplVulkanHpp_GetFrameIndex`
+};
+
+// Texture rewritten every frame (See `ImGui_ImplVulkanHpp_AddStreamingTexture`)
+struct ImGui_ImplVulkanHpp_StreamingTexDesc {
+    vk::Format format = vk::Format::eR8G8B8A8Unorm;
+    vk::Extent2D size;
+    uint32_t n_slots = 3;  // Staging slots (Frames in flight + 1)
+};
+
+// Mapped staging slot (See `ImGui_ImplVulkanHpp_AcquireTextureUpdate`)
+struct ImGui_ImplVulkanHpp_TextureUpdate {
+    uint8_t* pixels = nullptr;
+    vk::Extent2D size;
+    size_t row_bytes = 0;  // Tightly packed
+};
+
+// Target of pipelines compiled in advance
+// (See `ImGui_ImplVulkanHpp_PrewarmPipelines`)
+struct ImGui_ImplVulkanHpp_PipelineDesc {
+    vk::Format dst_img_format = vk::Format::eUndefined;
+    vk::ImageLayout dst_final_layout = vk::ImageLayout::ePresentSrcKHR;
+    bool has_bg = false;
+};
+
+// Statistics of the last `ImGui_ImplVulkanHpp_RenderDrawData` call
+struct ImGui_ImplVulkanHpp_FrameStats {
+    // CPU time of each phase [us]
+    float update_font_tex_us = 0.f;
+    float update_vtx_idx_bufs_us = 0.f;
+    float update_render_pipeline_us = 0.f;
+    float update_unif_buf_us = 0.f;
+    float record_draw_cmds_us = 0.f;
+
+    // Uploading
+    uint32_t n_vtxs_uploaded = 0;
+    uint32_t n_idxs_uploaded = 0;
+    size_t uploaded_bytes = 0;  // Host to device copies
+    uint32_t n_buf_reallocs = 0;
+    uint32_t n_quads_instanced = 0;
+    uint32_t n_tex_updates = 0;  // Streaming textures copied
+
+    // Recording
+    uint32_t n_draw_calls = 0;
+    uint32_t n_scissor_calls = 0;
+    uint32_t n_bind_calls = 0;  // Pipelines, descriptor sets and buffers
+    uint32_t n_culled_cmds = 0;
+    uint32_t n_user_callbacks = 0;
+    uint32_t n_bg_transfers = 0;  // BG composited by copy or blit
+
+    // Rebuilding (Non-zero values cause frame hitches)
+    uint32_t n_render_pass_rebuilds = 0;
+    uint32_t n_pipeline_rebuilds = 0;
+    uint32_t n_frame_buf_rebuilds = 0;
+    uint32_t n_retired_objs = 0;      // Waiting for frame completion
+    uint32_t n_skipped_overlays = 0;  // Pipelines were still compiling
+};
+
+// GPU time of a pass over the recent frames [ms]
+struct ImGui_ImplVulkanHpp_GpuTimingStat {
+    float avg_ms = 0.f;
+    float p50_ms = 0.f;
+    float p95_ms = 0.f;
+    float p99_ms = 0.f;
+    float max_ms = 0.f;
+};
+
+struct ImGui_ImplVulkanHpp_GpuTimings {
+    ImGui_ImplVulkanHpp_GpuTimingStat bg;     // BG subpass
+    ImGui_ImplVulkanHpp_GpuTimingStat imgui;  // ImGui subpass
+    ImGui_ImplVulkanHpp_GpuTimingStat total;  // Whole render pass
+    uint32_t n_samples = 0;
+};
+
+// Render state for `ImDrawCmd::UserCallback` (See
+// `ImGui_ImplVulkanHpp_GetRenderState`). Callbacks may record any command
+// which is valid in the subpass. Add `ImDrawCallback_ResetRenderState` after
+// a callback which changes pipeline, descriptor sets, buffers or viewport.
+struct ImGui_ImplVulkanHpp_RenderState {
+    vk::CommandBuffer cmd_buf;  // Recording inside the ImGui subpass
+    vk::RenderPass render_pass;
+    uint32_t subpass_idx = 0;
+    vk::Pipeline pipeline;  // ImGui pipeline
+    vk::PipelineLayout pipeline_layout;
+    vk::Extent2D fb_size;
+    vk::Rect2D scissor;  // `ClipRect` of the command (Empty if fully clipped)
+    ImVec2 display_pos;  // `ImDrawData::DisplayPos`
+    ImVec2 fb_scale;     // `ImDrawData::FramebufferScale`
+};
+
+enum class ImGui_ImplVulkanHpp_PlotType {
+    Lines,   // Line strip through all samples
+    Points,  // Square for each sample
+};
+
+// Plot drawn from raw samples in a GPU buffer
+// (See `ImGui_ImplVulkanHpp_AddPlot`)
+struct ImGui_ImplVulkanHpp_PlotDesc {
+    vk::Buffer samples_buf;  // Tightly packed `float` (Usage: vertex buffer)
+    vk::DeviceSize samples_offset = 0;
+    uint32_t n_samples = 0;
+    ImGui_ImplVulkanHpp_PlotType type = ImGui_ImplVulkanHpp_PlotType::Lines;
+    ImVec2 rect_min;  // Plot area in ImGui coordinates
+    ImVec2 rect_max;
+    float value_min = 0.f;  // Mapped to the bottom of the area
+    float value_max = 1.f;  // Mapped to the top of the area
+    ImU32 col = IM_COL32_WHITE;
+    float thickness = 1.f;  // Line width or point size
+};
+
+// Device memory owned by the backend (Pooled in large blocks)
+struct ImGui_ImplVulkanHpp_MemoryStats {
+    size_t reserved_bytes = 0;      // Allocated from the driver
+    size_t used_bytes = 0;          // Sub-allocated by backend resources
+    size_t device_local_bytes = 0;  // Part of `reserved_bytes`
+    uint32_t n_blocks = 0;          // Live `vkAllocateMemory` allocations
+    uint32_t n_allocs = 0;          // Live sub-allocations
+    uint32_t n_desc_pools = 0;      // Pools in all chains
+    uint32_t n_desc_sets = 0;       // Live descriptor sets
+};
+
 IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_Init();
 IMGUI_IMPL_API void ImGui_ImplVulkanHpp_Shutdown();
+// Passing another device releases all objects of the previous one, including
+// textures and offscreen targets. The previous device must be alive and idle.
 IMGUI_IMPL_API void ImGui_ImplVulkanHpp_NewFrame(
     const vk::PhysicalDevice& physical_device,
     const vk::UniqueDevice& device);
@@ -17,5 +246,112 @@ IMGUI_IMPL_API void ImGui_ImplVulkanHpp_RenderDrawData(
     const vk::ImageLayout& dst_final_layout = vk::ImageLayout::ePresentSrcKHR,
     const vk::ImageView& bg_img_view = {} /* optional */,
     const vk::ImageLayout& bg_img_layout = vk::ImageLayout::eUndefined);
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_SetOptions(
+    const ImGui_ImplVulkanHpp_Options& options);
+IMGUI_IMPL_API const ImGui_ImplVulkanHpp_Options&
+ImGui_ImplVulkanHpp_GetOptions();
+// Releases cached frame buffers of a destination view, and the descriptor set
+// of a BG view, after the frames using them complete. Call before destroying
+// the view (e.g. on swapchain recreation), so that a recycled handle never
+// finds a stale object. (Views unused for a while are released automatically)
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_ForgetTarget(
+    const vk::ImageView& img_view);
+// Populated by every `ImGui_ImplVulkanHpp_RenderDrawData` call.
+IMGUI_IMPL_API const ImGui_ImplVulkanHpp_FrameStats&
+ImGui_ImplVulkanHpp_GetFrameStats();
+// Timings are resolved without waiting, so they lag a few frames behind.
+IMGUI_IMPL_API ImGui_ImplVulkanHpp_GpuTimings
+ImGui_ImplVulkanHpp_GetGpuTimings();
+IMGUI_IMPL_API ImGui_ImplVulkanHpp_MemoryStats
+ImGui_ImplVulkanHpp_GetMemoryStats();
+// Valid only inside of user callbacks (Otherwise nullptr).
+IMGUI_IMPL_API const ImGui_ImplVulkanHpp_RenderState*
+ImGui_ImplVulkanHpp_GetRenderState();
+// Descriptor set freed when the frame completes (No update after binding).
+// Valid only inside of user callbacks. The layout may have up to 4 image
+// samplers or sampled images and 2 descriptors of other common types.
+IMGUI_IMPL_API vk::DescriptorSet ImGui_ImplVulkanHpp_AllocFrameDescSet(
+    const vk::DescriptorSetLayout& layout);
+// Enables copy/blit composition of the background for the next frame.
+// Call between `ImGui_ImplVulkanHpp_NewFrame` and
+// `ImGui_ImplVulkanHpp_RenderDrawData`.
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_SetBgImages(
+    const ImGui_ImplVulkanHpp_BgImages& bg_imgs);
+// Adds a plot to `draw_list`. Samples are expanded in the vertex shader and
+// clipped by the current clip rect, so no CPU tessellation or upload happens.
+// The buffer must be valid until the frame completes. Call between
+// `ImGui_ImplVulkanHpp_NewFrame` and `ImGui_ImplVulkanHpp_RenderDrawData`.
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_AddPlot(
+    ImDrawList* draw_list, const ImGui_ImplVulkanHpp_PlotDesc& desc);
+// Compiles pipelines for expected targets on background threads.
+// (Current options are used. Call after `ImGui_ImplVulkanHpp_NewFrame`)
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_PrewarmPipelines(
+    const ImGui_ImplVulkanHpp_PipelineDesc* descs, int n_descs);
+// Writes trace zones of the backend (`NewFrame`, `UpdateFontTex`,
+// `UpdateVtxIdxBufs`, `UpdateRenderPipeline`, `UpdateUnifBuf`,
+// `RecordDrawCmds` and background `BuildPipelineSet`) of every thread as
+// Chrome/Perfetto trace JSON. Timestamps are `std::chrono::steady_clock`
+// (CLOCK_MONOTONIC on Linux) in microseconds. Returns false when tracing is
+// compiled out (Define `IMGUI_IMPL_VULKANHPP_TRACE` to compile it in).
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_WriteTrace(const char* filename);
+// Index of the frame recorded by the last `RenderDrawData` call (From 1).
+IMGUI_IMPL_API uint64_t ImGui_ImplVulkanHpp_GetFrameIndex();
+// Reports that the GPU completed the frames up to `frame_idx` (e.g. its fence
+// or a timeline semaphore signaled with the frame index). Replaced objects are
+// kept alive until then, so that frames can be left in flight. Until the first
+// call, the previous frame is assumed to be completed at every frame.
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_SetCompletedFrameIndex(
+    uint64_t frame_idx);
+// Creates the ring of offscreen targets with host-cached readback buffers.
+// Replaced targets are released after their frames complete.
+// (Call after `ImGui_ImplVulkanHpp_NewFrame`)
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_CreateOffscreenTargets(
+    const ImGui_ImplVulkanHpp_OffscreenDesc& desc);
+// Renders into the next offscreen target and records its copy into the
+// readback buffer. Returns false only when the target is still in flight (The
+// frame is dropped instead of stalling, and nothing is recorded). Otherwise the
+// command buffer must be submitted even if nothing is drawn, since it carries
+// texture uploads (See `ImGui_ImplVulkanHpp_OffscreenSubmit::is_drawn`).
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_RenderDrawDataOffscreen(
+    ImDrawData* draw_data, const vk::UniqueCommandBuffer& dst_cmd_buf);
+// Gets the newest completed offscreen frame (Typically N-2). Pixels are valid
+// until its target is reused, `n_targets` frames later. (Not exportable only)
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_GetReadbackFrame(
+    ImGui_ImplVulkanHpp_ReadbackFrame& frame);
+IMGUI_IMPL_API const ImGui_ImplVulkanHpp_OffscreenSubmit&
+ImGui_ImplVulkanHpp_GetOffscreenSubmit();
+// Exports the memory and the semaphores of an exportable target as new fds.
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_ExportTarget(
+    uint32_t target_idx, ImGui_ImplVulkanHpp_ExportedTarget& exported);
+// Registers an image view of the caller as a texture for `ImGui::Image` etc.
+// Null sampler means the bilinear one of the backend. The view must be valid
+// until the texture is removed and its last frame completes. Only IDs returned
+// by this backend are valid (e.g. `VkDescriptorSet` is not); others are drawn
+// with the font atlas.
+// (Call after `ImGui_ImplVulkanHpp_NewFrame`)
+IMGUI_IMPL_API ImTextureID ImGui_ImplVulkanHpp_AddTexture(
+    const vk::ImageView& img_view,
+    const vk::ImageLayout& img_layout = vk::ImageLayout::eShaderReadOnlyOptimal,
+    const vk::Sampler& sampler = {});
+// Copies RGBA8 pixels into a backend-owned texture. Images up to 256x256 are
+// packed into shared atlas pages and their UVs are remapped at upload, so
+// draws of different icons need no descriptor rebinding. Pixels are uploaded
+// by the next `RenderDrawData`. (Call after `ImGui_ImplVulkanHpp_NewFrame`)
+IMGUI_IMPL_API ImTextureID ImGui_ImplVulkanHpp_AddAtlasTexture(
+    const uint8_t* rgba, uint32_t width, uint32_t height);
+// Creates a texture for per-frame contents such as camera or video frames.
+// Its staging slots are allocated once and stay mapped.
+// (Call after `ImGui_ImplVulkanHpp_NewFrame`)
+IMGUI_IMPL_API ImTextureID ImGui_ImplVulkanHpp_AddStreamingTexture(
+    const ImGui_ImplVulkanHpp_StreamingTexDesc& desc);
+// Gets a staging slot of a streaming texture to write the next contents into.
+// The copy is recorded before the ImGui pass of the next `RenderDrawData`.
+// Returns false when all slots are still in flight (Skip this update instead
+// of stalling). Acquiring again before the next frame returns the same slot.
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_AcquireTextureUpdate(
+    ImTextureID tex_id, ImGui_ImplVulkanHpp_TextureUpdate& update);
+// Releases a texture after its last frame completes. (Atlas space is not
+// reused)
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_RemoveTexture(ImTextureID tex_id);
 
 #endif /* end of include guard */
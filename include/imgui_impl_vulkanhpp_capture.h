@@ -0,0 +1,36 @@
+#ifndef IMGUI_IMPL_VULKANHPP_CAPTURE_H_20261018
+#define IMGUI_IMPL_VULKANHPP_CAPTURE_H_20261018
+
+#include <imgui.h>  // IMGUI_IMPL_API
+
+// -----------------------------------------------------------------------------
+// ------------------------------ ImDrawData Capture ---------------------------
+// -----------------------------------------------------------------------------
+// Serializes `ImDrawData` of each frame into a compact binary file.
+// (Draw lists, commands, vertices, indices, display metrics and texture IDs)
+// User callbacks cannot be serialized, so they are recorded as markers only.
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_BeginCapture(const char* filename);
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_CaptureFrame(
+        const ImDrawData* draw_data);
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_EndCapture();
+
+// -----------------------------------------------------------------------------
+// ------------------------------ ImDrawData Replay ----------------------------
+// -----------------------------------------------------------------------------
+// Memory-maps a capture file and provides `ImDrawData` of each frame.
+// Vertices and indices are referenced directly from the mapped file.
+struct ImGui_ImplVulkanHpp_Replay;
+
+IMGUI_IMPL_API ImGui_ImplVulkanHpp_Replay* ImGui_ImplVulkanHpp_OpenReplay(
+        const char* filename);
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_CloseReplay(
+        ImGui_ImplVulkanHpp_Replay* replay);
+IMGUI_IMPL_API int ImGui_ImplVulkanHpp_GetReplayFrameCount(
+        const ImGui_ImplVulkanHpp_Replay* replay);
+// Returned draw data is valid until the next call or `CloseReplay`.
+// Captured texture IDs are replaced by `tex_id` (e.g. `io.Fonts->TexID`),
+// because they are meaningless in another process.
+IMGUI_IMPL_API ImDrawData* ImGui_ImplVulkanHpp_GetReplayFrame(
+        ImGui_ImplVulkanHpp_Replay* replay, int frame_idx, ImTextureID tex_id);
+
+#endif /* end of include guard */
@@ -0,0 +1,55 @@
+#ifndef IMGUI_IMPL_VULKANHPP_PACER_H_20261018
+#define IMGUI_IMPL_VULKANHPP_PACER_H_20261018
+
+#include <imgui.h>  // IMGUI_IMPL_API
+
+#include <vulkan/vulkan.hpp>
+
+// -----------------------------------------------------------------------------
+// -------------------------------- Frame Pacer --------------------------------
+// -----------------------------------------------------------------------------
+// Owns command buffers and sync objects for each frame in flight, and recycles
+// them instead of creating new ones every frame. The CPU waits only when it
+// runs `n_frames_in_flight` frames ahead of the GPU, and completed frames are
+// reported to the backend (`ImGui_ImplVulkanHpp_SetCompletedFrameIndex`).
+// The fence covers submits only, not a present waiting on a semaphore, so the
+// semaphore waited by present must be owned per swapchain image instead.
+struct ImGui_ImplVulkanHpp_FramePacerDesc {
+    uint32_t queue_family_idx = 0;
+    uint32_t n_frames_in_flight = 2;
+    uint32_t n_cmd_bufs = 1;    // Per frame (e.g. scene and ImGui)
+    uint32_t n_semaphores = 1;  // Per frame (e.g. image acquired)
+};
+
+// Objects of the current frame (Valid until the next
+// `ImGui_ImplVulkanHpp_BeginPacedFrame`). The GPU has finished using them.
+struct ImGui_ImplVulkanHpp_PacedFrame {
+    uint32_t slot_idx = 0;  // [0, n_frames_in_flight) for per-frame resources
+    const vk::UniqueCommandBuffer* cmd_bufs = nullptr;  // `n_cmd_bufs`
+    const vk::Semaphore* semaphores = nullptr;          // `n_semaphores`
+    vk::Fence fence;  // Unsignaled. The last submit of the frame signals it.
+    float wait_us = 0.f;  // CPU time blocked for this slot to be completed
+};
+
+struct ImGui_ImplVulkanHpp_FramePacer;
+
+IMGUI_IMPL_API ImGui_ImplVulkanHpp_FramePacer*
+ImGui_ImplVulkanHpp_CreateFramePacer(
+        const vk::UniqueDevice& device,
+        const ImGui_ImplVulkanHpp_FramePacerDesc& desc);
+// Waits for all frames in flight. (Call before destroying the device)
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_DestroyFramePacer(
+        ImGui_ImplVulkanHpp_FramePacer* pacer);
+// Waits for the frame which used the next slot `n_frames_in_flight` frames ago
+// and reports its completion to the backend. (Call before recording)
+IMGUI_IMPL_API const ImGui_ImplVulkanHpp_PacedFrame&
+ImGui_ImplVulkanHpp_BeginPacedFrame(ImGui_ImplVulkanHpp_FramePacer* pacer);
+// Associates the slot with `ImGui_ImplVulkanHpp_GetFrameIndex`.
+// (Call after the submit which signals the fence)
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_EndPacedFrame(
+        ImGui_ImplVulkanHpp_FramePacer* pacer);
+// Waits for all frames in flight (e.g. before recreating the swapchain).
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_WaitPacedFramesIdle(
+        ImGui_ImplVulkanHpp_FramePacer* pacer);
+
+#endif /* end of include guard */
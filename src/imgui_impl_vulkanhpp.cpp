@@ -4,17 +4,42 @@ BEGIN_VKW_SUPPRESS_WARNING
 #include "imgui_impl_vulkanhpp.h"
 END_VKW_SUPPRESS_WARNING
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <future>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <tuple>
 
+// SIMD for clip rects (x86-64 and AArch64 always have one of them)
+#if defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGUI_IMPL_VULKANHPP_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define IMGUI_IMPL_VULKANHPP_NEON
+#include <arm_neon.h>
+#endif
+
 namespace {
 
 // -----------------------------------------------------------------------------
 // --------------------------------- Constants ---------------------------------
 // -----------------------------------------------------------------------------
+static_assert(sizeof(ImDrawIdx) == 2 || sizeof(ImDrawIdx) == 4,
+              "ImDrawIdx must be 16-bit or 32-bit");
 constexpr auto IDX_TYPE = (sizeof(ImDrawIdx) == 2) ? vk::IndexType::eUint16 :
                                                      vk::IndexType::eUint32;
+// Frame buffers unused for this many frames are released (Transient targets)
+constexpr uint64_t N_FRAME_BUF_IDLE_FRAMES = 120;
 
 // -----------------------------------------------------------------------------
 // ---------------------------------- Shaders ----------------------------------
@@ -56,9 +81,97 @@ void main() {
     vtx_col = col;
 }
 )";
+const std::string IMGUI_COMPACT_VERT_SOURCE = R"(
+#version 460
+layout (binding = 0) uniform UnifBuf {
+    vec2 scale;
+    vec2 shift;
+    vec2 origin;  // Compact positions are relative to it
+} uniform_buf;
+layout (location = 0) in ivec2 pos;  // Fixed point (1/4 pixel)
+layout (location = 1) in vec2 uv;
+layout (location = 2) in vec4 col;
+layout (location = 0) out vec2 vtx_uv;
+layout (location = 1) out vec4 vtx_col;
+void main() {
+    vec2 pos_f = vec2(pos) * 0.25 + uniform_buf.origin;
+    gl_Position = vec4(uniform_buf.scale * pos_f + uniform_buf.shift, 0.0, 1.0);
+    vtx_uv = uv;
+    vtx_col = col;
+}
+)";
+// Vertex pulling variants read vertices from a storage buffer.
+const std::string IMGUI_PULL_VERT_SOURCE = R"(
+#version 460
+layout (binding = 0) uniform UnifBuf {
+    vec2 scale;
+    vec2 shift;
+} uniform_buf;
+layout (binding = 1) readonly buffer VtxBuf {
+    uint data[];  // ImDrawVert (5 words)
+} vtx_buf;
+layout (location = 0) out vec2 vtx_uv;
+layout (location = 1) out vec4 vtx_col;
+void main() {
+    uint base = uint(gl_VertexIndex) * 5u;
+    vec2 pos = uintBitsToFloat(uvec2(vtx_buf.data[base + 0u],
+                                     vtx_buf.data[base + 1u]));
+    vec2 uv = uintBitsToFloat(uvec2(vtx_buf.data[base + 2u],
+                                    vtx_buf.data[base + 3u]));
+    gl_Position = vec4(uniform_buf.scale * pos + uniform_buf.shift, 0.0, 1.0);
+    vtx_uv = uv;
+    vtx_col = unpackUnorm4x8(vtx_buf.data[base + 4u]);
+}
+)";
+const std::string IMGUI_PULL_COMPACT_VERT_SOURCE = R"(
+#version 460
+layout (binding = 0) uniform UnifBuf {
+    vec2 scale;
+    vec2 shift;
+    vec2 origin;  // Compact positions are relative to it
+} uniform_buf;
+layout (binding = 1) readonly buffer VtxBuf {
+    uint data[];  // CompactVert (3 words)
+} vtx_buf;
+layout (location = 0) out vec2 vtx_uv;
+layout (location = 1) out vec4 vtx_col;
+void main() {
+    uint base = uint(gl_VertexIndex) * 3u;
+    int pos_packed = int(vtx_buf.data[base + 0u]);
+    ivec2 pos = ivec2(bitfieldExtract(pos_packed, 0, 16),
+                      bitfieldExtract(pos_packed, 16, 16));
+    vec2 pos_f = vec2(pos) * 0.25 + uniform_buf.origin;
+    gl_Position = vec4(uniform_buf.scale * pos_f + uniform_buf.shift, 0.0, 1.0);
+    vtx_uv = unpackUnorm2x16(vtx_buf.data[base + 1u]);
+    vtx_col = unpackUnorm4x8(vtx_buf.data[base + 2u]);
+}
+)";
+// Instanced quads expand a record into 2 triangles (PrimRectUV order)
+const std::string IMGUI_QUAD_VERT_SOURCE = R"(
+#version 460
+layout (binding = 0) uniform UnifBuf {
+    vec2 scale;
+    vec2 shift;
+} uniform_buf;
+layout (location = 0) in vec4 rect;     // Top-left and bottom-right
+layout (location = 1) in vec4 uv_rect;  // UVs of the corners above
+layout (location = 2) in vec4 col;
+layout (location = 0) out vec2 vtx_uv;
+layout (location = 1) out vec4 vtx_col;
+const int CORNERS[6] = int[](0, 1, 2, 0, 2, 3);
+void main() {
+    int corner = CORNERS[gl_VertexIndex];
+    vec2 t = vec2((corner == 1 || corner == 2) ? 1.0 : 0.0,
+                  (2 <= corner) ? 1.0 : 0.0);
+    vec2 pos = mix(rect.xy, rect.zw, t);
+    gl_Position = vec4(uniform_buf.scale * pos + uniform_buf.shift, 0.0, 1.0);
+    vtx_uv = mix(uv_rect.xy, uv_rect.zw, t);
+    vtx_col = col;
+}
+)";
 const std::string IMGUI_FRAG_SOURCE = R"(
 #version 460
-layout (set = 0, binding = 1) uniform sampler2D tex;
+layout (set = 1, binding = 0) uniform sampler2D tex;  // ImTextureID
 layout (location = 0) in vec2 vtx_uv;
 layout (location = 1) in vec4 vtx_col;
 layout (location = 0) out vec4 frag_col;
@@ -67,9 +180,531 @@ void main() {
 }
 )";
 
+// Plots expand raw samples into quads (Line segments or points)
+const std::string PLOT_COMMON_SOURCE = R"(
+#version 460
+layout (binding = 0) uniform UnifBuf {
+    vec2 scale;
+    vec2 shift;
+} uniform_buf;
+layout (binding = 2) readonly buffer PlotBuf {
+    vec2 rect_min;
+    vec2 rect_size;
+    float value_min;
+    float value_scale;
+    float thickness;
+    uint n_samples;
+    vec4 col;
+} plot;
+layout (location = 0) out vec4 vtx_col;
+const int CORNERS[6] = int[](0, 1, 2, 2, 1, 3);
+vec2 ToDisplay(float idx, float value) {
+    float x = idx / float(max(plot.n_samples, 2u) - 1u);
+    float y = clamp((value - plot.value_min) * plot.value_scale, 0.0, 1.0);
+    y = 1.0 - y;  // Upward
+    return plot.rect_min + vec2(x, y) * plot.rect_size;
+}
+void EmitVertex(vec2 pos) {
+    gl_Position = vec4(uniform_buf.scale * pos + uniform_buf.shift, 0.0, 1.0);
+    vtx_col = plot.col;
+}
+)";
+const std::string PLOT_LINE_VERT_SOURCE = PLOT_COMMON_SOURCE + R"(
+layout (location = 0) in float value0;  // Sample i (Per instance)
+layout (location = 1) in float value1;  // Sample i + 1 (Per instance)
+void main() {
+    float idx = float(gl_InstanceIndex);
+    vec2 p0 = ToDisplay(idx, value0);
+    vec2 p1 = ToDisplay(idx + 1.0, value1);
+    vec2 dir = p1 - p0;
+    float len = length(dir);
+    dir = (0.0 < len) ? dir / len : vec2(1.0, 0.0);
+    vec2 normal = vec2(-dir.y, dir.x) * (plot.thickness * 0.5);
+    int corner = CORNERS[gl_VertexIndex];
+    EmitVertex(((corner & 2) == 0 ? p0 : p1) +
+               ((corner & 1) == 0 ? normal : -normal));
+}
+)";
+const std::string PLOT_POINT_VERT_SOURCE = PLOT_COMMON_SOURCE + R"(
+layout (location = 0) in float value;  // Sample i (Per instance)
+void main() {
+    vec2 center = ToDisplay(float(gl_InstanceIndex), value);
+    int corner = CORNERS[gl_VertexIndex];
+    vec2 dir = vec2((corner & 1) == 0 ? -1.0 : 1.0,
+                    (corner & 2) == 0 ? -1.0 : 1.0);
+    EmitVertex(center + dir * (plot.thickness * 0.5));
+}
+)";
+const std::string PLOT_FRAG_SOURCE = R"(
+#version 460
+layout (location = 0) in vec4 vtx_col;
+layout (location = 0) out vec4 frag_col;
+void main() {
+    frag_col = vtx_col;
+}
+)";
+
 struct UnifBuf {
     float scale[2];
     float shift[2];
+    float origin[2];  // `DisplayPos`
+};
+
+// Matches `PlotBuf` (std430)
+struct PlotBuf {
+    float rect_min[2];
+    float rect_size[2];
+    float value_min;
+    float value_scale;
+    float thickness;
+    uint32_t n_samples;
+    float col[4];
+};
+static_assert(sizeof(PlotBuf) == 48, "Unexpected padding");
+
+// Quantized ImDrawVert (12 bytes instead of 20 bytes)
+struct CompactVert {
+    int16_t pos[2];  // Fixed point with 2 fractional bits
+    uint16_t uv[2];  // Normalized
+    uint32_t col;
+};
+static_assert(sizeof(CompactVert) == 12, "Unexpected padding");
+constexpr float COMPACT_POS_SCALE = 4.f;
+constexpr float COMPACT_POS_MAX = 32767.f / COMPACT_POS_SCALE;  // From origin
+constexpr float COMPACT_UV_SCALE = 65535.f;
+
+size_t GetVtxStride(ImGui_ImplVulkanHpp_VertexFormat vtx_format) {
+    return (vtx_format == ImGui_ImplVulkanHpp_VertexFormat::Compact) ?
+                   sizeof(CompactVert) :
+                   sizeof(ImDrawVert);
+}
+
+// -----------------------------------------------------------------------------
+// ------------------------------- Quad Packing --------------------------------
+// -----------------------------------------------------------------------------
+// Axis-aligned textured quad as one instance (36 bytes instead of 92 bytes)
+struct QuadInst {
+    float rect[4];  // Positions of top-left and bottom-right corners
+    float uv[4];    // UVs of the same corners
+    uint32_t col;
+};
+static_assert(sizeof(QuadInst) == 36, "Unexpected padding");
+constexpr uint32_t QUAD_BINDING = 1;  // Not to disturb ImGui vertex binding
+
+// Draw command after packing (Keeps the order of ImGui commands)
+struct PackedCmd {
+    const ImDrawList* cmd_list = nullptr;
+    const ImDrawCmd* pcmd = nullptr;  // Clip rect and callback
+    bool is_quads = false;
+    uint32_t first = 0;  // First index or instance
+    uint32_t count = 0;  // Number of indices or instances
+    int32_t vtx_offset = 0;
+};
+
+// Rebuilt geometry of a frame (Buffers are reused over frames)
+struct QuadPacking {
+    std::vector<ImDrawVert> vtxs;  // Only for non-quad triangles
+    std::vector<ImDrawIdx> idxs;
+    std::vector<QuadInst> quads;
+    std::vector<PackedCmd> cmds;
+    std::vector<uint32_t> vtx_remap;  // Source vertex -> Packed vertex
+};
+
+// -----------------------------------------------------------------------------
+// ------------------------------ Clip Rect Culling ----------------------------
+// -----------------------------------------------------------------------------
+// Draw left by the culling pre-pass
+struct VisibleDraw {
+    const PackedCmd* cmd = nullptr;  // User callbacks are kept in order
+    vk::Rect2D scissor;
+    bool is_scissor_changed = false;
+};
+
+// Clip rects in structure-of-arrays form for SIMD (Padded to 4)
+struct ClipCulling {
+    std::vector<PackedCmd> list_cmds;  // Draw lists without packing
+    std::vector<uint32_t> rect_idxs;   // Command -> Rect
+    std::vector<float> x0s, y0s, x1s, y1s;
+    std::vector<int32_t> offset_xs, offset_ys, extent_ws, extent_hs;
+    std::vector<uint32_t> visible_masks;  // All bits are set when visible
+    std::vector<VisibleDraw> draws;
+};
+
+// -----------------------------------------------------------------------------
+// -------------------------------- Memory Pool --------------------------------
+// -----------------------------------------------------------------------------
+// Device memory is allocated in large blocks and sub-allocated for each
+// resource, which keeps `vkAllocateMemory` calls few and predictable.
+constexpr vk::DeviceSize MEM_BLOCK_SIZE = 8 * 1024 * 1024;
+
+size_t AlignUp(size_t n_bytes, size_t alignment) {
+    return (n_bytes + alignment - 1) / alignment * alignment;
+}
+
+struct MemBlock {
+    vk::UniqueDeviceMemory dev_mem;
+    uint32_t mem_type_idx = 0;
+    bool is_linear = true;  // Buffers and optimal images never share a block
+    bool is_dedicated = false;  // One resource only (e.g. exported)
+    size_t size = 0;
+    size_t used = 0;
+    uint32_t n_allocs = 0;
+    uint8_t* mapped_p = nullptr;           // Persistently mapped if possible
+    std::map<size_t, size_t> free_ranges;  // Offset -> Size
+
+    bool alloc(size_t n_bytes, size_t alignment, size_t& dst_offset) {
+        // First fit
+        for (auto it = free_ranges.begin(); it != free_ranges.end(); it++) {
+            const size_t range_beg = it->first;
+            const size_t range_end = it->first + it->second;
+            const size_t offset = AlignUp(range_beg, alignment);
+            if (range_end < offset + n_bytes) {
+                continue;
+            }
+            free_ranges.erase(it);
+            if (range_beg < offset) {
+                free_ranges[range_beg] = offset - range_beg;
+            }
+            if (offset + n_bytes < range_end) {
+                free_ranges[offset + n_bytes] = range_end - offset - n_bytes;
+            }
+            used += n_bytes;
+            n_allocs++;
+            dst_offset = offset;
+            return true;
+        }
+        return false;
+    }
+
+    void free(size_t offset, size_t n_bytes) {
+        used -= n_bytes;
+        n_allocs--;
+        // Insert and merge with neighbors
+        auto it = free_ranges.emplace(offset, n_bytes).first;
+        const auto next = std::next(it);
+        if (next != free_ranges.end() && offset + n_bytes == next->first) {
+            it->second += next->second;
+            free_ranges.erase(next);
+        }
+        if (it != free_ranges.begin()) {
+            const auto prev = std::prev(it);
+            if (prev->first + prev->second == it->first) {
+                prev->second += it->second;
+                free_ranges.erase(it);
+            }
+        }
+    }
+};
+
+// Sub-allocated range of a block
+struct MemRange {
+    std::shared_ptr<MemBlock> block;  // Keeps the block alive
+    size_t offset = 0;
+    size_t size = 0;
+    uint8_t* mapped_p = nullptr;
+
+    void release() {
+        if (block) {
+            block->free(offset, size);
+            block = nullptr;
+        }
+    }
+};
+
+struct PooledBuffer {
+    vk::UniqueBuffer buf;
+    MemRange mem;
+
+    ~PooledBuffer() {
+        buf.reset();
+        mem.release();
+    }
+};
+using PooledBufferPtr = std::shared_ptr<PooledBuffer>;
+
+struct PooledImage {
+    vk::UniqueImage img;
+    vk::UniqueImageView view;
+    vk::Extent2D size;
+    MemRange mem;
+
+    ~PooledImage() {
+        view.reset();
+        img.reset();
+        mem.release();
+    }
+};
+using PooledImagePtr = std::shared_ptr<PooledImage>;
+
+struct MemPool {
+    vk::PhysicalDeviceMemoryProperties mem_props;
+    std::vector<std::shared_ptr<MemBlock>> blocks;
+};
+
+// -----------------------------------------------------------------------------
+// ------------------------------ Descriptor Pool ------------------------------
+// -----------------------------------------------------------------------------
+// Sets of one layout are allocated from a chain of pools, which grows by
+// doubling instead of creating a pool for every set.
+constexpr uint32_t DESC_POOL_MIN_SETS = 16;
+constexpr uint32_t DESC_POOL_MAX_SETS = 4096;
+
+struct DescPoolChain {
+    vkw::DescSetPackPtr layout_pack;  // Null for transient chains (Any layout)
+    std::vector<vk::DescriptorPoolSize> sizes_per_set;
+    std::vector<vk::UniqueDescriptorPool> pools;
+    size_t pool_idx = 0;  // Pools before this one are full
+    uint32_t n_next_sets = DESC_POOL_MIN_SETS;
+    uint32_t n_sets = 0;                      // Allocated from pools
+    std::vector<vk::DescriptorSet> free_sets;  // Released long-lived sets
+};
+using DescPoolChainPtr = std::shared_ptr<DescPoolChain>;
+
+// Long-lived set, which returns to the free list of its chain instead of
+// being freed. (Released only after the last frame using it completed)
+struct PooledDescSet {
+    vk::DescriptorSet desc_set;
+    DescPoolChainPtr chain;  // Keeps the pools alive
+
+    ~PooledDescSet() {
+        if (chain) {
+            chain->free_sets.push_back(desc_set);
+        }
+    }
+};
+using PooledDescSetPtr = std::shared_ptr<PooledDescSet>;
+
+// -----------------------------------------------------------------------------
+// ----------------------------------- Arena -----------------------------------
+// -----------------------------------------------------------------------------
+// One host visible buffer sub-allocated for all per-frame data.
+// (Uniform, vertices and indices are bump-allocated and reset every frame)
+// An arena is reused only after its last frame completed, so there are as
+// many arenas as frames in flight.
+constexpr size_t ARENA_MIN_CAPACITY = 256 * 1024;
+// Range of the vertex pulling descriptor. Dynamic offset + range must stay in
+// the buffer, so the vertex region is always allocated with the whole range.
+constexpr size_t ARENA_MIN_VTX_RANGE = 64 * 1024;
+const vk::BufferUsageFlags ARENA_USAGE =
+        vk::BufferUsageFlagBits::eUniformBuffer |
+        vk::BufferUsageFlagBits::eStorageBuffer |
+        vk::BufferUsageFlagBits::eVertexBuffer |
+        vk::BufferUsageFlagBits::eIndexBuffer;
+
+struct Arena {
+    PooledBufferPtr buf;
+    PooledDescSetPtr desc_set;          // Refers to `buf`
+    DescPoolChainPtr frame_desc_pools;  // Transient sets (Reset on reuse)
+    uint8_t* mapped_p = nullptr;        // Persistently mapped
+    size_t capacity = 0;
+    size_t head = 0;
+    size_t vtx_range = 0;  // Bound range of vertices (See `WriteImGuiDescSet`)
+    uint64_t last_frame_idx = 0;  // Last frame which used this arena
+
+    // Offsets of the current frame
+    size_t unif_offset = 0;
+    size_t vtx_offset = 0;
+    size_t idx_offset = 0;
+    size_t quad_offset = 0;
+};
+
+// -----------------------------------------------------------------------------
+// ------------------------------- Pipeline Cache ------------------------------
+// -----------------------------------------------------------------------------
+// (Destination format, Initial layout, Final layout, Has BG)
+using RenderPassKey =
+        std::tuple<vk::Format, vk::ImageLayout, vk::ImageLayout, bool>;
+// (Destination format, Final layout, Has BG, Has overlay, Vertex format,
+//  Vertex pulling, Instanced quads)
+using PipelineKey =
+        std::tuple<vk::Format, vk::ImageLayout, bool, bool,
+                   ImGui_ImplVulkanHpp_VertexFormat, bool, bool>;
+
+// Pipelines depending on ImGui options (BG is not included, so that it is
+// drawn while they are compiling)
+struct PipelineSet {
+    vkw::PipelinePackPtr imgui_pipeline_pack;
+    vkw::PipelinePackPtr quad_pipeline_pack;  // Only with instanced quads
+    vkw::PipelinePackPtr composite_pipeline_pack;  // Only with overlay
+    vkw::PipelinePackPtr plot_line_pipeline_pack;
+    vkw::PipelinePackPtr plot_point_pipeline_pack;
+};
+using PipelineSetPtr = std::shared_ptr<PipelineSet>;
+using PipelineFuture = std::shared_future<PipelineSetPtr>;
+
+// Inputs of a pipeline build (Copied to be used on background threads)
+struct PipelineBuildInfo {
+    const vk::UniqueDevice* device_p = nullptr;
+    vkw::RenderPassPackPtr render_pass_pack;  // Where ImGui is drawn
+    bool has_bg = false;                      // In `render_pass_pack`
+    vkw::RenderPassPackPtr dst_render_pass_pack;  // Only with overlay
+    bool dst_has_bg = false;
+    ImGui_ImplVulkanHpp_VertexFormat vtx_format =
+            ImGui_ImplVulkanHpp_VertexFormat::Float;
+    bool vtx_pulling = false;
+    bool instanced_quads = false;
+    vkw::ShaderModulePackPtr bg_vert_shader_pack;
+    vkw::ShaderModulePackPtr bg_frag_shader_pack;
+    vkw::ShaderModulePackPtr imgui_vert_shader_pack;  // Selected variant
+    vkw::ShaderModulePackPtr imgui_frag_shader_pack;
+    vkw::ShaderModulePackPtr quad_vert_shader_pack;
+    vkw::ShaderModulePackPtr plot_line_vert_shader_pack;
+    vkw::ShaderModulePackPtr plot_point_vert_shader_pack;
+    vkw::ShaderModulePackPtr plot_frag_shader_pack;
+    vkw::DescSetPackPtr bg_desc_set_pack;     // Layout only
+    vkw::DescSetPackPtr imgui_desc_set_pack;  // Layout only
+    vkw::DescSetPackPtr tex_desc_set_pack;    // Layout only
+};
+
+// ImGui pass at a reduced resolution, upscaled into the destination
+struct OverlayTarget {
+    PooledImagePtr img;
+    vk::Format format = vk::Format::eUndefined;
+    vkw::RenderPassPackPtr render_pass_pack;  // Cleared on load
+    vkw::FrameBufferPackPtr frame_buf;
+    PooledDescSetPtr desc_set;  // Sampled by the composite
+};
+using OverlayTargetPtr = std::shared_ptr<OverlayTarget>;
+
+// -----------------------------------------------------------------------------
+// ------------------------------- Retire Queue --------------------------------
+// -----------------------------------------------------------------------------
+// Replaced objects are kept alive until the GPU completed the last frame
+// which may use them.
+struct RetiredObj {
+    uint64_t frame_idx = 0;
+    std::shared_ptr<void> obj;
+};
+
+// -----------------------------------------------------------------------------
+// -------------------------------- Offscreen Ring -----------------------------
+// -----------------------------------------------------------------------------
+// Color target and its readback buffer. A slot is reused only after its frame
+// completed, so readback never waits for the queue.
+const vk::ExternalMemoryHandleTypeFlagBits EXPORT_MEM_HANDLE_TYPE =
+        vk::ExternalMemoryHandleTypeFlagBits::eOpaqueFd;
+const vk::ExternalSemaphoreHandleTypeFlagBits EXPORT_SEMAPHORE_HANDLE_TYPE =
+        vk::ExternalSemaphoreHandleTypeFlagBits::eOpaqueFd;
+const vk::ImageUsageFlags EXPORT_IMG_USAGE =
+        vk::ImageUsageFlagBits::eColorAttachment |
+        vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc;
+
+struct OffscreenSlot {
+    PooledImagePtr img;
+    PooledBufferPtr readback_buf;  // Host cached if possible (Not exportable)
+    vk::UniqueSemaphore ready_semaphore;  // Exportable only
+    vk::UniqueSemaphore release_semaphore;  // Exportable only (By importer)
+    bool is_released = false;  // Owned by the importer until acquired back
+    uint64_t frame_idx = 0;  // Frame of the contents (0: Not rendered)
+};
+
+struct OffscreenRing {
+    ImGui_ImplVulkanHpp_OffscreenDesc desc;
+    std::vector<OffscreenSlot> slots;
+    size_t next_idx = 0;
+    size_t row_bytes = 0;
+    bool is_coherent = false;  // Otherwise invalidated before reading
+    ImGui_ImplVulkanHpp_OffscreenSubmit last_submit;
+};
+using OffscreenRingPtr = std::shared_ptr<OffscreenRing>;
+
+// -----------------------------------------------------------------------------
+// ---------------------------------- Textures ---------------------------------
+// -----------------------------------------------------------------------------
+// Small images are packed into shared pages by a skyline (Bottom-left rule)
+constexpr uint32_t ATLAS_PAGE_SIZE = 1024;
+constexpr uint32_t ATLAS_MAX_ENTRY_SIZE = 256;  // Larger ones get own pages
+constexpr uint32_t ATLAS_PADDING = 1;  // Replicated edge against bleeding
+
+// Top edge of packed area over [x, x + width)
+struct SkylineNode {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+};
+
+// Pixels waiting to be copied into a page
+struct AtlasUpload {
+    PooledBufferPtr buf;
+    vk::Offset2D offset;
+    vk::Extent2D size;
+};
+
+struct AtlasPage {
+    PooledImagePtr img;
+    PooledDescSetPtr desc_set;
+    std::vector<SkylineNode> skyline;  // Empty for dedicated pages
+    std::vector<AtlasUpload> uploads;
+    bool is_initialized = false;  // Contents are undefined before any upload
+};
+using AtlasPagePtr = std::shared_ptr<AtlasPage>;
+
+// Texture rewritten by the caller every frame. Pixels are written into a
+// persistently mapped staging slot, which is reused after its frame completed.
+constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+struct StagingSlot {
+    PooledBufferPtr buf;
+    uint64_t frame_idx = 0;  // Last frame which copied from this slot
+};
+
+struct StreamingTex {
+    PooledImagePtr img;
+    std::vector<StagingSlot> slots;
+    size_t row_bytes = 0;
+    uint32_t pending_idx = NO_SLOT;  // Written, copied by the next frame
+    uint32_t next_idx = 0;
+    bool is_initialized = false;  // Cleared by the first frame otherwise
+};
+using StreamingTexPtr = std::shared_ptr<StreamingTex>;
+
+// Object behind `ImTextureID`. Atlas entries share the descriptor set of their
+// page, so that consecutive draws of different icons need no rebinding.
+struct Texture {
+    PooledDescSetPtr desc_set;    // Set 1 of ImGui pipelines
+    AtlasPagePtr page;            // Null for views of the caller
+    StreamingTexPtr stream;       // Streaming textures only
+    bool is_atlas_entry = false;  // UVs are remapped into the page
+    ImVec2 uv_scale = {1.f, 1.f};
+    ImVec2 uv_offset = {0.f, 0.f};
+};
+using TexturePtr = std::shared_ptr<Texture>;
+
+// -----------------------------------------------------------------------------
+// --------------------------------- GPU Timing --------------------------------
+// -----------------------------------------------------------------------------
+enum TimestampIdx : uint32_t {
+    TIMESTAMP_BEGIN = 0,
+    TIMESTAMP_BG_END,
+    TIMESTAMP_IMGUI_END,
+    N_TIMESTAMPS,
+};
+constexpr uint32_t N_TIMESTAMP_FRAMES = 4;  // Frames in flight for queries
+constexpr size_t N_TIMING_SAMPLES = 128;    // Rolling window
+
+// Rolling window of durations
+struct TimingSamples {
+    std::array<float, N_TIMING_SAMPLES> values_ms;
+    size_t n_values = 0;
+    size_t head = 0;
+
+    void push(float value_ms) {
+        values_ms[head] = value_ms;
+        head = (head + 1) % N_TIMING_SAMPLES;
+        n_values = std::min(n_values + 1, N_TIMING_SAMPLES);
+    }
+};
+
+struct GpuTiming {
+    vk::UniqueQueryPool query_pool;
+    float timestamp_period_ns = 0.f;
+    uint64_t timestamp_mask = 0;  // `timestampValidBits` of the queue family
+    uint64_t n_frames = 0;
+    std::array<bool, N_TIMESTAMP_FRAMES> is_pending = {};
+
+    TimingSamples bg_samples;
+    TimingSamples imgui_samples;
+    TimingSamples total_samples;
 };
 
 // -----------------------------------------------------------------------------
@@ -82,328 +717,2881 @@ struct Context {
     vkw::ShaderModulePackPtr bg_vert_shader_pack;
     vkw::ShaderModulePackPtr bg_frag_shader_pack;
     vkw::ShaderModulePackPtr imgui_vert_shader_pack;
+    vkw::ShaderModulePackPtr imgui_compact_vert_shader_pack;
+    vkw::ShaderModulePackPtr imgui_pull_vert_shader_pack;
+    vkw::ShaderModulePackPtr imgui_pull_compact_vert_shader_pack;
     vkw::ShaderModulePackPtr imgui_frag_shader_pack;
+    vkw::ShaderModulePackPtr imgui_quad_vert_shader_pack;
+    vkw::ShaderModulePackPtr plot_line_vert_shader_pack;
+    vkw::ShaderModulePackPtr plot_point_vert_shader_pack;
+    vkw::ShaderModulePackPtr plot_frag_shader_pack;
 
-    vkw::BufferPackPtr unif_buf_pack;
-    UnifBuf unif_buf;
+    size_t min_unif_offset_align = 1;
+    size_t min_storage_offset_align = 1;
+    size_t non_coherent_atom_size = 1;
+    MemPool mem_pool;
+    std::vector<Arena> arenas;
+    size_t arena_idx = 0;  // Arena of the current frame
+
+    uint64_t frame_idx = 0;
+    uint64_t completed_frame_idx = 0;
+    bool is_frame_tracked = false;  // Completion is reported by the caller
+    std::deque<RetiredObj> retired_objs;
 
     uint8_t* font_pixel_p = nullptr;
     size_t font_pixel_size = 0;
-    vkw::ImagePackPtr font_img_pack;
-    vkw::TexturePackPtr font_tex_pack;
+    PooledImagePtr font_img;
+    vk::UniqueSampler font_sampler;
     bool is_font_tex_sent = false;
-    vkw::BufferPackPtr font_buf_pack;
+    PooledBufferPtr font_buf;
+    TexturePtr font_tex;  // `io.Fonts->TexID`
+
+    // Textures registered by the caller
+    vkw::DescSetPackPtr tex_layout_desc_set_pack;  // Layout for pipelines
+    DescPoolChainPtr tex_desc_pools;
+    std::map<const Texture*, TexturePtr> textures;
+    std::vector<AtlasPagePtr> atlas_pages;  // Shared pages open for packing
+    std::vector<AtlasPagePtr> dirty_pages;  // Pages with pending uploads
+    std::vector<StreamingTexPtr> streaming_texs;
+    std::vector<vk::ImageMemoryBarrier> stream_barriers;  // Reused
 
-    vkw::DescSetPackPtr imgui_desc_set_pack;
-    vkw::WriteDescSetPackPtr imgui_write_desc_set_pack;
-    vkw::DescSetPackPtr bg_desc_set_pack;
-    vkw::WriteDescSetPackPtr bg_write_desc_set_pack;
+    vkw::DescSetPackPtr imgui_desc_set_pack;     // Layout for pipelines
+    vkw::DescSetPackPtr bg_layout_desc_set_pack;  // Layout for pipelines
+    DescPoolChainPtr imgui_desc_pools;  // Sets of arenas
+    DescPoolChainPtr bg_desc_pools;     // Sets of BG and the overlay target
+    PooledDescSetPtr bg_desc_set;
 
     vk::UniqueSampler bg_sampler;
 
-    vk::Format dst_img_format = vk::Format::eUndefined;
-    vk::ImageLayout dst_final_layout = vk::ImageLayout::eUndefined;
     vk::ImageView bg_img_view;
     vk::ImageLayout bg_img_layout;
+    ImGui_ImplVulkanHpp_BgImages bg_imgs;  // Current frame only
+    std::map<vk::Format, vk::FormatFeatureFlags> format_features;
+    // Selected for the current frame (Subpass only for the shader)
+    ImGui_ImplVulkanHpp_BgComposite bg_composite =
+            ImGui_ImplVulkanHpp_BgComposite::Shader;
+    bool has_bg_pass = false;
+    ImGui_ImplVulkanHpp_VertexFormat vtx_format =
+            ImGui_ImplVulkanHpp_VertexFormat::Float;
+    bool vtx_pulling = false;
+    bool instanced_quads = false;
+    QuadPacking quad_packing;
+    std::vector<uint8_t> uv_remapped;  // Vertices of a list (Reused)
+    ClipCulling clip_culling;
+
+    // Cached for each target
+    std::map<RenderPassKey, vkw::RenderPassPackPtr> render_pass_cache;
+    std::map<PipelineKey, PipelineFuture> pipeline_cache;
+
+    // BG is created synchronously for each destination render pass
+    std::map<const vkw::RenderPassPack*, vkw::PipelinePackPtr>
+            bg_pipeline_map;
 
+    // Current frame (Pipelines of the set are null while compiling)
     vkw::RenderPassPackPtr render_pass_pack;
     vkw::PipelinePackPtr bg_pipeline_pack;
     vkw::PipelinePackPtr imgui_pipeline_pack;
+    vkw::PipelinePackPtr quad_pipeline_pack;
+    vkw::PipelinePackPtr plot_line_pipeline_pack;
+    vkw::PipelinePackPtr plot_point_pipeline_pack;
+
+    // Reduced overlay (Null at full resolution)
+    OverlayTargetPtr overlay_target;
+    vkw::PipelinePackPtr composite_pipeline_pack;
+    // Pass where ImGui is drawn (Overlay or destination)
+    vkw::RenderPassPackPtr imgui_render_pass_pack;
+    uint32_t imgui_subpass_idx = 0;
+
+    // Headless rendering (Null until created)
+    OffscreenRingPtr offscreen_ring;
+
+    using FrameBufKey = std::tuple<VkImageView, uint32_t, uint32_t,
+                                   const vkw::RenderPassPack*>;
+    struct CachedFrameBuf {
+        vkw::FrameBufferPackPtr frame_buf;
+        uint64_t last_frame_idx = 0;  // Last frame which used it
+    };
+    std::map<FrameBufKey, CachedFrameBuf> frame_buf_map;
+
+    // Plots of the current frame (Parameters are placed in the arena)
+    std::vector<ImGui_ImplVulkanHpp_PlotDesc> plot_descs;
+    std::vector<size_t> plot_offsets;
 
-    using FrameBufKey = std::tuple<const vk::ImageView*, const vk::Extent2D*>;
-    std::map<FrameBufKey, vkw::FrameBufferPackPtr> frame_buf_map;
+    ImGui_ImplVulkanHpp_RenderState render_state;
+    bool is_in_callback = false;
 
-    size_t vtx_size = 0;
-    vkw::BufferPackPtr vtx_buf_pack;
-    size_t idx_size = 0;
-    vkw::BufferPackPtr idx_buf_pack;
+    ImGui_ImplVulkanHpp_Options options;
+    ImGui_ImplVulkanHpp_FrameStats frame_stats;
+    GpuTiming gpu_timing;
 };
 
 // Global Context
 Context g_ctx;
 
 // -----------------------------------------------------------------------------
-// ------------------------------ Vulkan Utility -------------------------------
+// ------------------------------- Stats Utility -------------------------------
 // -----------------------------------------------------------------------------
-uint8_t* MapDeviceMem(const vk::UniqueDevice& device,
-                      const vkw::BufferPackPtr& buf_pack, size_t n_bytes) {
-    // Map
-    uint8_t* dev_p = static_cast<uint8_t*>(device->mapMemory(
-            buf_pack->dev_mem_pack->dev_mem.get(), 0, n_bytes));
-    return dev_p;
+class ScopedTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ScopedTimer(float& dst_us) : m_dst_us(dst_us) {}
+    ~ScopedTimer() {
+        const auto elapsed = Clock::now() - m_start;
+        m_dst_us = std::chrono::duration<float, std::micro>(elapsed).count();
+    }
+
+private:
+    float& m_dst_us;
+    const Clock::time_point m_start = Clock::now();
+};
+
+// -----------------------------------------------------------------------------
+// ------------------------------- Trace Utility -------------------------------
+// -----------------------------------------------------------------------------
+// Scoped zones of hot paths, compiled in with `IMGUI_IMPL_VULKANHPP_TRACE`.
+// Each thread appends to its own ring, so recording takes no lock.
+#if defined(IMGUI_IMPL_VULKANHPP_TRACE)
+constexpr uint64_t N_TRACE_EVENTS = 1 << 14;  // Per thread (Oldest are lost)
+
+struct TraceEvent {
+    const char* name = nullptr;  // String literal
+    int64_t begin_ns = 0;        // `steady_clock`
+    int64_t end_ns = 0;
+};
+
+// Event in the ring (Atomics, because readers copy it while it is rewritten)
+struct TraceSlot {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<int64_t> begin_ns{0};
+    std::atomic<int64_t> end_ns{0};
+};
+
+// Written only by its thread. Readers take events below `n_written`, and drop
+// ones which may have been overwritten while reading. (Seqlock)
+struct TraceBuffer {
+    uint32_t tid = 0;
+    std::atomic<uint64_t> n_written{0};
+    std::vector<TraceSlot> slots = std::vector<TraceSlot>(N_TRACE_EVENTS);
+};
+using TraceBufferPtr = std::shared_ptr<TraceBuffer>;
+
+// Buffers outlive their threads, so that events of finished threads remain
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<TraceBufferPtr> buffers;
+};
+
+TraceRegistry& GetTraceRegistry() {
+    static TraceRegistry registry;
+    return registry;
 }
 
-void UnmapDeviceMem(const vk::UniqueDevice& device,
-                    const vkw::BufferPackPtr& buf_pack) {
-    // Unmap
-    device->unmapMemory(buf_pack->dev_mem_pack->dev_mem.get());
+TraceBuffer& GetThreadTraceBuffer() {
+    thread_local TraceBufferPtr buffer;
+    if (!buffer) {
+        // Only once for each thread
+        buffer = std::make_shared<TraceBuffer>();
+        auto& registry = GetTraceRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        buffer->tid = static_cast<uint32_t>(registry.buffers.size() + 1);
+        registry.buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+int64_t GetTraceNowNs() {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+class TraceZone {
+public:
+    explicit TraceZone(const char* name) : m_name(name) {}
+    ~TraceZone() {
+        auto& buffer = GetThreadTraceBuffer();
+        const uint64_t n = buffer.n_written.load(std::memory_order_relaxed);
+        auto& slot = buffer.slots[n % N_TRACE_EVENTS];
+        // Readers which see any of the new fields also see `n_written == n`
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(m_name, std::memory_order_relaxed);
+        slot.begin_ns.store(m_begin_ns, std::memory_order_relaxed);
+        slot.end_ns.store(GetTraceNowNs(), std::memory_order_relaxed);
+        buffer.n_written.store(n + 1, std::memory_order_release);
+    }
+
+private:
+    const char* m_name;
+    const int64_t m_begin_ns = GetTraceNowNs();
+};
+
+void WriteTraceBuffer(FILE* fp, const TraceBuffer& buffer, bool& is_first) {
+    // Copy the ring, then drop events overwritten during the copy
+    const uint64_t n_end = buffer.n_written.load(std::memory_order_acquire);
+    const uint64_t n_begin =
+            (N_TRACE_EVENTS < n_end) ? n_end - N_TRACE_EVENTS : 0;
+    std::vector<TraceEvent> events;
+    events.reserve(static_cast<size_t>(n_end - n_begin));
+    for (uint64_t i = n_begin; i < n_end; i++) {
+        const TraceSlot& slot = buffer.slots[i % N_TRACE_EVENTS];
+        TraceEvent event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.begin_ns = slot.begin_ns.load(std::memory_order_relaxed);
+        event.end_ns = slot.end_ns.load(std::memory_order_relaxed);
+        events.push_back(event);
+    }
+    // Loads of the copy must not be reordered after the re-check
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t n_after = buffer.n_written.load(std::memory_order_relaxed);
+    const uint64_t n_valid_begin = std::max(
+            n_begin,
+            (N_TRACE_EVENTS <= n_after) ? n_after + 1 - N_TRACE_EVENTS : 0);
+
+    std::fprintf(fp,
+                 "%s{\"name\": \"thread_name\", \"ph\": \"M\", "
+                 "\"pid\": 1, \"tid\": %u, "
+                 "\"args\": {\"name\": \"imgui_vkhpp %u\"}}",
+                 is_first ? "" : ",\n", buffer.tid, buffer.tid);
+    is_first = false;
+    for (uint64_t i = n_valid_begin; i < n_end; i++) {
+        const TraceEvent& event = events[static_cast<size_t>(i - n_begin)];
+        std::fprintf(fp,
+                     ",\n{\"name\": \"%s\", \"ph\": \"X\", "
+                     "\"pid\": 1, \"tid\": %u, "
+                     "\"ts\": %.3f, \"dur\": %.3f}",
+                     event.name, buffer.tid,
+                     static_cast<double>(event.begin_ns) * 1e-3,
+                     static_cast<double>(event.end_ns - event.begin_ns) *
+                             1e-3);
+    }
 }
 
+#define IMGUI_IMPL_VULKANHPP_CONCAT_IMPL(a, b) a##b
+#define IMGUI_IMPL_VULKANHPP_CONCAT(a, b) IMGUI_IMPL_VULKANHPP_CONCAT_IMPL(a, b)
+#define IMGUI_IMPL_VULKANHPP_TRACE_ZONE(name) \
+        TraceZone IMGUI_IMPL_VULKANHPP_CONCAT(trace_zone_, __LINE__)(name)
+#else
+#define IMGUI_IMPL_VULKANHPP_TRACE_ZONE(name)
+#endif
+
 // -----------------------------------------------------------------------------
-// ------------------------------- ImGui Utility -------------------------------
+// ---------------------------- Memory Pool Utility ----------------------------
 // -----------------------------------------------------------------------------
-ImVec2 ObtainImDrawSize(ImDrawData* draw_data) {
-    auto fb_width_f = draw_data->DisplaySize.x * draw_data->FramebufferScale.x;
-    auto fb_height_f = draw_data->DisplaySize.y * draw_data->FramebufferScale.y;
-    return {fb_width_f, fb_height_f};
+uint32_t FindMemTypeIdx(uint32_t type_bits,
+                        const vk::MemoryPropertyFlags& props) {
+    const auto& mem_props = g_ctx.mem_pool.mem_props;
+    for (uint32_t i = 0; i < mem_props.memoryTypeCount; i++) {
+        if ((type_bits & (1u << i)) &&
+            (mem_props.memoryTypes[i].propertyFlags & props) == props) {
+            return i;
+        }
+    }
+    throw std::runtime_error("Failed to find memory type for ImGui backend");
 }
 
-bool UpdateVtxIdxBufs(ImDrawData* draw_data) {
-    auto&& physical_device = *g_ctx.physical_device_p;
+MemRange AllocMem(const vk::MemoryRequirements& reqs,
+                  const vk::MemoryPropertyFlags& props, bool is_linear) {
     auto&& device = *g_ctx.device_p;
+    auto& pool = g_ctx.mem_pool;
+    const uint32_t mem_type_idx = FindMemTypeIdx(reqs.memoryTypeBits, props);
+    const size_t n_bytes = static_cast<size_t>(reqs.size);
+    const size_t alignment = static_cast<size_t>(reqs.alignment);
 
-    // Create Host Visible Buffers
-    const size_t& vtx_size =
-            static_cast<size_t>(draw_data->TotalVtxCount) * sizeof(ImDrawVert);
-    const size_t& idx_size =
-            static_cast<size_t>(draw_data->TotalIdxCount) * sizeof(ImDrawIdx);
-    if (vtx_size == 0 || idx_size == 0) {
-        return false;  // Failed
+    MemRange range;
+    range.size = n_bytes;
+    for (auto&& block : pool.blocks) {
+        if (block->mem_type_idx == mem_type_idx &&
+            block->is_linear == is_linear && !block->is_dedicated &&
+            block->alloc(n_bytes, alignment, range.offset)) {
+            range.block = block;
+            break;
+        }
     }
-    if (vtx_size != g_ctx.vtx_size) {  // Create Vertex Buffer
-        g_ctx.vtx_size = vtx_size;
-        g_ctx.vtx_buf_pack =
-                vkw::CreateBufferPack(physical_device, device, vtx_size,
-                                      vk::BufferUsageFlagBits::eVertexBuffer,
-                                      vkw::HOST_VISIB_COHER_PROPS);
+    if (!range.block) {
+        // New block (Large resources get a dedicated one)
+        auto block = std::make_shared<MemBlock>();
+        block->mem_type_idx = mem_type_idx;
+        block->is_linear = is_linear;
+        block->size = std::max(static_cast<size_t>(MEM_BLOCK_SIZE),
+                               AlignUp(n_bytes, alignment));
+        block->dev_mem = device->allocateMemoryUnique(
+                {static_cast<vk::DeviceSize>(block->size), mem_type_idx});
+        const auto& mem_type = pool.mem_props.memoryTypes[mem_type_idx];
+        if (mem_type.propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) {
+            block->mapped_p = static_cast<uint8_t*>(device->mapMemory(
+                    block->dev_mem.get(), 0, VK_WHOLE_SIZE));
+        }
+        block->free_ranges[0] = block->size;
+        block->alloc(n_bytes, alignment, range.offset);
+        pool.blocks.push_back(block);
+        range.block = block;
     }
-    if (idx_size != g_ctx.idx_size) {  // Create Index Buffer
-        g_ctx.idx_size = idx_size;
-        g_ctx.idx_buf_pack =
-                vkw::CreateBufferPack(physical_device, device, idx_size,
-                                      vk::BufferUsageFlagBits::eIndexBuffer,
-                                      vkw::HOST_VISIB_COHER_PROPS);
+    if (range.block->mapped_p) {
+        range.mapped_p = range.block->mapped_p + range.offset;
     }
+    return range;
+}
+
+// Releases blocks which have no allocation
+void TrimMemPool() {
+    auto& blocks = g_ctx.mem_pool.blocks;
+    blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                                [](const std::shared_ptr<MemBlock>& block) {
+                                    return block->n_allocs == 0;
+                                }),
+                 blocks.end());
+}
+
+PooledBufferPtr CreatePooledBuffer(size_t n_bytes,
+                                   const vk::BufferUsageFlags& usage,
+                                   const vk::MemoryPropertyFlags& props) {
+    auto&& device = *g_ctx.device_p;
+    auto buf = std::make_shared<PooledBuffer>();
+    buf->buf = device->createBufferUnique(
+            {{}, static_cast<vk::DeviceSize>(n_bytes), usage});
+    buf->mem = AllocMem(device->getBufferMemoryRequirements(buf->buf.get()),
+                        props, true);
+    device->bindBufferMemory(buf->buf.get(), buf->mem.block->dev_mem.get(),
+                             static_cast<vk::DeviceSize>(buf->mem.offset));
+    return buf;
+}
+
+PooledImagePtr CreatePooledImage(const vk::Format& format,
+                                 const vk::Extent2D& size,
+                                 const vk::ImageUsageFlags& usage) {
+    auto&& device = *g_ctx.device_p;
+    auto img = std::make_shared<PooledImage>();
+    img->size = size;
+    img->img = device->createImageUnique(
+            {{}, vk::ImageType::e2D, format, {size.width, size.height, 1}, 1,
+             1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+             usage});
+    img->mem = AllocMem(device->getImageMemoryRequirements(img->img.get()),
+                        vk::MemoryPropertyFlagBits::eDeviceLocal, false);
+    device->bindImageMemory(img->img.get(), img->mem.block->dev_mem.get(),
+                            static_cast<vk::DeviceSize>(img->mem.offset));
+    img->view = device->createImageViewUnique(
+            {{}, img->img.get(), vk::ImageViewType::e2D, format, {},
+             {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}});
+    return img;
+}
+
+// Uploads whole image from buffer and makes it readable from shaders
+void CmdUploadImage(const vk::UniqueCommandBuffer& cmd_buf,
+                    const PooledBufferPtr& src_buf,
+                    const PooledImagePtr& dst_img) {
+    const vk::ImageSubresourceRange subres_range = {
+            vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+    const vk::ImageMemoryBarrier to_transfer = {
+            {},
+            vk::AccessFlagBits::eTransferWrite,
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eTransferDstOptimal,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            dst_img->img.get(),
+            subres_range};
+    cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                             vk::PipelineStageFlagBits::eTransfer, {}, nullptr,
+                             nullptr, to_transfer);
+    const vk::BufferImageCopy region = {
+            0,
+            0,
+            0,
+            {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+            {0, 0, 0},
+            {dst_img->size.width, dst_img->size.height, 1}};
+    cmd_buf->copyBufferToImage(src_buf->buf.get(), dst_img->img.get(),
+                               vk::ImageLayout::eTransferDstOptimal, region);
+    const vk::ImageMemoryBarrier to_shader = {
+            vk::AccessFlagBits::eTransferWrite,
+            vk::AccessFlagBits::eShaderRead,
+            vk::ImageLayout::eTransferDstOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            dst_img->img.get(),
+            subres_range};
+    cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                             vk::PipelineStageFlagBits::eFragmentShader, {},
+                             nullptr, nullptr, to_shader);
+}
+
+// Image in its own exportable allocation. (Sub-allocated memory cannot be
+// exported without exposing its neighbors)
+PooledImagePtr CreateExportableImage(const vk::Format& format,
+                                     const vk::Extent2D& size,
+                                     const vk::ImageUsageFlags& usage) {
+    auto&& device = *g_ctx.device_p;
+    auto img = std::make_shared<PooledImage>();
+    img->size = size;
+    const vk::ExternalMemoryImageCreateInfo ext_info = {
+            EXPORT_MEM_HANDLE_TYPE};
+    vk::ImageCreateInfo img_info = {
+            {}, vk::ImageType::e2D, format, {size.width, size.height, 1}, 1,
+            1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+            usage};
+    img_info.pNext = &ext_info;
+    img->img = device->createImageUnique(img_info);
+
+    // Dedicated block (Registered to the pool only for statistics)
+    const auto reqs = device->getImageMemoryRequirements(img->img.get());
+    auto block = std::make_shared<MemBlock>();
+    block->mem_type_idx = FindMemTypeIdx(
+            reqs.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+    block->is_linear = false;
+    block->is_dedicated = true;
+    block->size = static_cast<size_t>(reqs.size);
+    const vk::MemoryDedicatedAllocateInfo dedicated_info = {img->img.get()};
+    vk::ExportMemoryAllocateInfo export_info = {EXPORT_MEM_HANDLE_TYPE};
+    export_info.pNext = &dedicated_info;
+    vk::MemoryAllocateInfo alloc_info = {reqs.size, block->mem_type_idx};
+    alloc_info.pNext = &export_info;
+    block->dev_mem = device->allocateMemoryUnique(alloc_info);
+    block->free_ranges[0] = block->size;
+    block->alloc(block->size, 1, img->mem.offset);
+    g_ctx.mem_pool.blocks.push_back(block);
+    img->mem.block = block;
+    img->mem.size = block->size;
+
+    device->bindImageMemory(img->img.get(), block->dev_mem.get(), 0);
+    img->view = device->createImageViewUnique(
+            {{}, img->img.get(), vk::ImageViewType::e2D, format, {},
+             {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}});
+    return img;
+}
+
+// Binary semaphore exportable as an opaque fd
+vk::UniqueSemaphore CreateExportableSemaphore() {
+    const vk::ExportSemaphoreCreateInfo export_info = {
+            EXPORT_SEMAPHORE_HANDLE_TYPE};
+    vk::SemaphoreCreateInfo semaphore_info;
+    semaphore_info.pNext = &export_info;
+    return (*g_ctx.device_p)->createSemaphoreUnique(semaphore_info);
+}
+
+bool HasMemType(const vk::MemoryPropertyFlags& props) {
+    const auto& mem_props = g_ctx.mem_pool.mem_props;
+    for (uint32_t i = 0; i < mem_props.memoryTypeCount; i++) {
+        if ((mem_props.memoryTypes[i].propertyFlags & props) == props) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IsCoherentMem(const MemRange& mem) {
+    const auto& mem_props = g_ctx.mem_pool.mem_props;
+    const auto& mem_type = mem_props.memoryTypes[mem.block->mem_type_idx];
+    return static_cast<bool>(mem_type.propertyFlags &
+                             vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+// Makes device writes visible to the host (Non-coherent memory only)
+void InvalidateMem(const MemRange& mem) {
+    auto&& device = *g_ctx.device_p;
+    const size_t atom = g_ctx.non_coherent_atom_size;
+    const size_t beg = mem.offset / atom * atom;
+    const size_t end = std::min(AlignUp(mem.offset + mem.size, atom),
+                                mem.block->size);
+    device->invalidateMappedMemoryRanges(
+            {{mem.block->dev_mem.get(), static_cast<vk::DeviceSize>(beg),
+              static_cast<vk::DeviceSize>(end - beg)}});
+}
+
+size_t GetPixelBytes(const vk::Format& format) {
+    switch (format) {
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Srgb:
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+        case vk::Format::eA2B10G10R10UnormPack32:
+            return 4;
+        case vk::Format::eR16G16B16A16Sfloat:
+            return 8;
+        case vk::Format::eR32G32B32A32Sfloat:
+            return 16;
+        default:
+            throw std::runtime_error("Unsupported offscreen format");
+    }
+}
+
+// Copies whole image (Rendered into TRANSFER_SRC layout) into a host readable
+// buffer
+void CmdReadbackImage(const vk::UniqueCommandBuffer& cmd_buf,
+                      const PooledImagePtr& src_img,
+                      const PooledBufferPtr& dst_buf) {
+    const vk::ImageMemoryBarrier to_transfer = {
+            vk::AccessFlagBits::eColorAttachmentWrite,
+            vk::AccessFlagBits::eTransferRead,
+            vk::ImageLayout::eTransferSrcOptimal,
+            vk::ImageLayout::eTransferSrcOptimal,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            src_img->img.get(),
+            {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}};
+    cmd_buf->pipelineBarrier(
+            vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr,
+            to_transfer);
+    const vk::BufferImageCopy region = {
+            0,
+            0,
+            0,
+            {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+            {0, 0, 0},
+            {src_img->size.width, src_img->size.height, 1}};
+    cmd_buf->copyImageToBuffer(src_img->img.get(),
+                               vk::ImageLayout::eTransferSrcOptimal,
+                               dst_buf->buf.get(), region);
+    const vk::BufferMemoryBarrier to_host = {
+            vk::AccessFlagBits::eTransferWrite,
+            vk::AccessFlagBits::eHostRead,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            dst_buf->buf.get(),
+            0,
+            VK_WHOLE_SIZE};
+    cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                             vk::PipelineStageFlagBits::eHost, {}, nullptr,
+                             to_host, nullptr);
+}
+
+// Hands over a rendered image (In SHADER_READ_ONLY layout) to an importer
+void CmdReleaseToExternal(const vk::UniqueCommandBuffer& cmd_buf,
+                          const PooledImagePtr& img,
+                          uint32_t queue_family_idx) {
+    const vk::ImageMemoryBarrier to_external = {
+            vk::AccessFlagBits::eColorAttachmentWrite,
+            {},
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            queue_family_idx,
+            VK_QUEUE_FAMILY_EXTERNAL,
+            img->img.get(),
+            {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}};
+    cmd_buf->pipelineBarrier(
+            vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, nullptr,
+            to_external);
+}
+
+// Takes back an image released by the importer (In SHADER_READ_ONLY layout).
+// (Its release semaphore is waited at COLOR_ATTACHMENT_OUTPUT)
+void CmdAcquireFromExternal(const vk::UniqueCommandBuffer& cmd_buf,
+                            const PooledImagePtr& img,
+                            uint32_t queue_family_idx) {
+    const vk::ImageMemoryBarrier from_external = {
+            {},
+            vk::AccessFlagBits::eColorAttachmentWrite,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            VK_QUEUE_FAMILY_EXTERNAL,
+            queue_family_idx,
+            img->img.get(),
+            {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}};
+    cmd_buf->pipelineBarrier(
+            vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, nullptr,
+            nullptr, from_external);
+}
+
+// -----------------------------------------------------------------------------
+// ---------------------------- Retire Queue Utility ---------------------------
+// -----------------------------------------------------------------------------
+// Keeps `obj` alive until `last_frame_idx` is done
+void Retire(std::shared_ptr<void> obj, uint64_t last_frame_idx) {
+    if (!obj) {
+        return;
+    }
+    g_ctx.retired_objs.push_back({last_frame_idx, std::move(obj)});
+    g_ctx.frame_stats.n_retired_objs =
+            static_cast<uint32_t>(g_ctx.retired_objs.size());
+}
+
+// While recording, the previous frame is the last possible user of `obj`
+void Retire(std::shared_ptr<void> obj) {
+    Retire(std::move(obj), g_ctx.frame_idx - 1);
+}
+
+void CollectRetired() {
+    auto& retired_objs = g_ctx.retired_objs;
+    bool is_released = false;
+    while (!retired_objs.empty() &&
+           retired_objs.front().frame_idx <= g_ctx.completed_frame_idx) {
+        retired_objs.pop_front();
+        is_released = true;
+    }
+    g_ctx.frame_stats.n_retired_objs =
+            static_cast<uint32_t>(retired_objs.size());
+    if (is_released) {
+        TrimMemPool();
+    }
+}
+
+void AdvanceFrame() {
+    if (!g_ctx.is_frame_tracked) {
+        // Caller is assumed to wait for the previous frame (Legacy behavior)
+        g_ctx.completed_frame_idx = g_ctx.frame_idx;
+    }
+    g_ctx.frame_idx++;
+    CollectRetired();
+}
+
+// Releases everything sub-allocated from the memory pool at once, and then
+// its blocks. (For a device change. The previous device must be idle)
+void ReleasePooledObjects() {
+    g_ctx.retired_objs.clear();
+    g_ctx.offscreen_ring.reset();
+    g_ctx.overlay_target.reset();
+    g_ctx.arenas.clear();
+    g_ctx.textures.clear();  // IDs of the caller fall back to the font atlas
+    g_ctx.atlas_pages.clear();
+    g_ctx.dirty_pages.clear();
+    g_ctx.streaming_texs.clear();
+    g_ctx.font_tex.reset();
+    g_ctx.font_buf.reset();
+    g_ctx.font_img.reset();
+    g_ctx.is_font_tex_sent = false;  // Sent again to the new device
+    g_ctx.mem_pool.blocks.clear();
+}
+
+// -----------------------------------------------------------------------------
+// -------------------------- Descriptor Pool Utility --------------------------
+// -----------------------------------------------------------------------------
+DescPoolChainPtr CreateDescPoolChain(
+        const vkw::DescSetPackPtr& layout_pack,
+        std::vector<vk::DescriptorPoolSize> sizes_per_set) {
+    auto chain = std::make_shared<DescPoolChain>();
+    chain->layout_pack = layout_pack;
+    chain->sizes_per_set = std::move(sizes_per_set);
+    return chain;
+}
+
+// Transient sets may have any layout within these counts
+DescPoolChainPtr CreateTransientDescPoolChain() {
+    return CreateDescPoolChain(
+            nullptr, {{vk::DescriptorType::eSampler, 2},
+                      {vk::DescriptorType::eCombinedImageSampler, 4},
+                      {vk::DescriptorType::eSampledImage, 4},
+                      {vk::DescriptorType::eStorageImage, 2},
+                      {vk::DescriptorType::eUniformBuffer, 2},
+                      {vk::DescriptorType::eStorageBuffer, 2},
+                      {vk::DescriptorType::eUniformBufferDynamic, 2},
+                      {vk::DescriptorType::eStorageBufferDynamic, 2}});
+}
+
+void AddDescPool(DescPoolChain& chain) {
+    auto&& device = *g_ctx.device_p;
+    const uint32_t n_sets = chain.n_next_sets;
+    std::vector<vk::DescriptorPoolSize> pool_sizes = chain.sizes_per_set;
+    for (auto&& pool_size : pool_sizes) {
+        pool_size.descriptorCount *= n_sets;
+    }
+    chain.pools.push_back(device->createDescriptorPoolUnique(
+            {{}, n_sets, static_cast<uint32_t>(pool_sizes.size()),
+             pool_sizes.data()}));
+    chain.n_next_sets = std::min(n_sets * 2, DESC_POOL_MAX_SETS);
+}
+
+// Allocates from the current pool, moving to the next one when it is full
+vk::DescriptorSet AllocFromChain(DescPoolChain& chain,
+                                 const vk::DescriptorSetLayout& layout) {
+    auto&& device = *g_ctx.device_p;
+    vk::DescriptorSet desc_set;
+    while (true) {
+        const bool is_new_pool = (chain.pool_idx == chain.pools.size());
+        if (is_new_pool) {
+            AddDescPool(chain);
+        }
+        const vk::DescriptorSetAllocateInfo alloc_info(
+                chain.pools[chain.pool_idx].get(), 1, &layout);
+        const vk::Result ret =
+                device->allocateDescriptorSets(&alloc_info, &desc_set);
+        if (ret == vk::Result::eSuccess) {
+            chain.n_sets++;
+            return desc_set;
+        }
+        const bool is_full = (ret == vk::Result::eErrorOutOfPoolMemory ||
+                              ret == vk::Result::eErrorFragmentedPool);
+        if (!is_full || is_new_pool) {
+            throw std::runtime_error("Failed to allocate descriptor set");
+        }
+        chain.pool_idx++;
+    }
+}
+
+// Long-lived set with the layout of `chain` (Released sets are reused first)
+PooledDescSetPtr AllocDescSet(const DescPoolChainPtr& chain) {
+    auto desc_set = std::make_shared<PooledDescSet>();
+    if (chain->free_sets.empty()) {
+        desc_set->desc_set = AllocFromChain(
+                *chain, chain->layout_pack->desc_set_layout.get());
+    } else {
+        desc_set->desc_set = chain->free_sets.back();
+        chain->free_sets.pop_back();
+    }
+    desc_set->chain = chain;
+    return desc_set;
+}
+
+// Frees all sets at once (Frames using them must be completed)
+void ResetDescPoolChain(DescPoolChain& chain) {
+    auto&& device = *g_ctx.device_p;
+    for (size_t i = 0; i < chain.pools.size() && i <= chain.pool_idx; i++) {
+        device->resetDescriptorPool(chain.pools[i].get());
+    }
+    chain.pool_idx = 0;
+    chain.n_sets = 0;
+}
+
+// Image sampler at binding 0 (Textures, BG and the overlay target)
+void WriteImageDescSet(const vk::DescriptorSet& desc_set,
+                       const vk::Sampler& sampler,
+                       const vk::ImageView& img_view,
+                       const vk::ImageLayout& img_layout) {
+    auto&& device = *g_ctx.device_p;
+    const vk::DescriptorImageInfo img_info(sampler, img_view, img_layout);
+    const vk::WriteDescriptorSet write(
+            desc_set, 0, 0, 1, vk::DescriptorType::eCombinedImageSampler,
+            &img_info);
+    device->updateDescriptorSets(write, nullptr);
+}
+
+void AddDescPoolStats(const DescPoolChainPtr& chain,
+                      ImGui_ImplVulkanHpp_MemoryStats& mem_stats) {
+    if (!chain) {
+        return;
+    }
+    mem_stats.n_desc_pools += static_cast<uint32_t>(chain->pools.size());
+    mem_stats.n_desc_sets +=
+            chain->n_sets - static_cast<uint32_t>(chain->free_sets.size());
+}
+
+// -----------------------------------------------------------------------------
+// ------------------------------- Arena Utility -------------------------------
+// -----------------------------------------------------------------------------
+vkw::DescSetPackPtr CreateImGuiDescSetPack() {
+    return vkw::CreateDescriptorSetPack(
+            *g_ctx.device_p,
+            {{vk::DescriptorType::eUniformBufferDynamic, 1,
+              vk::ShaderStageFlagBits::eVertex},  // Uniform buffer
+             {vk::DescriptorType::eStorageBufferDynamic, 1,
+              vk::ShaderStageFlagBits::eVertex},  // Vertex pulling
+             {vk::DescriptorType::eStorageBufferDynamic, 1,
+              vk::ShaderStageFlagBits::eVertex}});  // Plot parameters
+}
+
+void WriteImGuiDescSet(const Arena& arena) {
+    auto&& device = *g_ctx.device_p;
+    const vk::Buffer arena_buf = arena.buf->buf.get();
+    const vk::DescriptorSet desc_set = arena.desc_set->desc_set;
+
+    // Offsets are decided at binding time by dynamic offsets. Ranges are
+    // bounded, since offset + range must stay in the buffer.
+    const vk::DescriptorBufferInfo unif_info(arena_buf, 0, sizeof(UnifBuf));
+    const vk::DescriptorBufferInfo vtx_info(arena_buf, 0, arena.vtx_range);
+    const vk::DescriptorBufferInfo plot_info(arena_buf, 0, sizeof(PlotBuf));
+    const std::array<vk::WriteDescriptorSet, 3> writes = {
+            vk::WriteDescriptorSet(desc_set, 0, 0, 1,
+                                   vk::DescriptorType::eUniformBufferDynamic,
+                                   nullptr, &unif_info),
+            vk::WriteDescriptorSet(desc_set, 1, 0, 1,
+                                   vk::DescriptorType::eStorageBufferDynamic,
+                                   nullptr, &vtx_info),
+            vk::WriteDescriptorSet(desc_set, 2, 0, 1,
+                                   vk::DescriptorType::eStorageBufferDynamic,
+                                   nullptr, &plot_info)};
+    device->updateDescriptorSets(writes, nullptr);
+}
+
+// Picks an arena which is not used by frames in flight
+Arena& AcquireArena() {
+    auto& arenas = g_ctx.arenas;
+    size_t idx = 0;
+    while (idx < arenas.size() &&
+           g_ctx.completed_frame_idx < arenas[idx].last_frame_idx) {
+        idx++;
+    }
+    if (idx == arenas.size()) {
+        arenas.emplace_back();
+        arenas.back().desc_set = AllocDescSet(g_ctx.imgui_desc_pools);
+        arenas.back().frame_desc_pools = CreateTransientDescPoolChain();
+    } else {
+        // Transient sets of the completed frame are freed at once
+        ResetDescPoolChain(*arenas[idx].frame_desc_pools);
+    }
+    g_ctx.arena_idx = idx;
+    arenas[idx].last_frame_idx = g_ctx.frame_idx;
+    return arenas[idx];
+}
+
+Arena& GetCurrArena() {
+    return g_ctx.arenas[g_ctx.arena_idx];
+}
+
+// Grows the range of vertices to `vtx_size` (Before `ReserveArena`)
+void ReserveArenaVtxRange(Arena& arena, size_t vtx_size) {
+    if (vtx_size <= arena.vtx_range) {
+        return;
+    }
+    size_t vtx_range = std::max(arena.vtx_range, ARENA_MIN_VTX_RANGE);
+    while (vtx_range < vtx_size) {
+        vtx_range *= 2;
+    }
+    arena.vtx_range = vtx_range;
+    // Not used by frames in flight (See `AcquireArena`)
+    if (arena.buf) {
+        WriteImGuiDescSet(arena);
+    }
+}
+
+void ReserveArena(Arena& arena, size_t n_bytes) {
+    if (n_bytes <= arena.capacity) {
+        return;
+    }
+
+    // Grow geometrically to avoid frequent reallocation
+    size_t capacity = std::max(arena.capacity, ARENA_MIN_CAPACITY);
+    while (capacity < n_bytes) {
+        capacity *= 2;
+    }
+    // Old buffer is not used by frames in flight (See `AcquireArena`)
+    arena.buf = CreatePooledBuffer(capacity, ARENA_USAGE,
+                                   vkw::HOST_VISIB_COHER_PROPS);
+    arena.mapped_p = arena.buf->mem.mapped_p;
+    arena.capacity = capacity;
+    TrimMemPool();  // Old buffer may have left an empty block
+    g_ctx.frame_stats.n_buf_reallocs++;
+
+    // Descriptors refer to the new buffer
+    WriteImGuiDescSet(arena);
+}
+
+void ResetArena(Arena& arena) {
+    arena.head = 0;
+}
+
+// Bump allocation (Capacity must be reserved beforehand)
+size_t AllocArena(Arena& arena, size_t n_bytes, size_t alignment) {
+    const size_t offset = AlignUp(arena.head, alignment);
+    arena.head = offset + n_bytes;
+    return offset;
+}
+
+// -----------------------------------------------------------------------------
+// ------------------------------ Texture Utility ------------------------------
+// -----------------------------------------------------------------------------
+PooledDescSetPtr CreateTexDescSet(const vk::Sampler& sampler,
+                                  const vk::ImageView& img_view,
+                                  const vk::ImageLayout& img_layout) {
+    auto desc_set = AllocDescSet(g_ctx.tex_desc_pools);
+    WriteImageDescSet(desc_set->desc_set, sampler, img_view, img_layout);
+    return desc_set;
+}
+
+// `ImTextureID` is the pointer to `Texture` registered in this backend.
+// Null and unknown IDs (e.g. `VkDescriptorSet` of the upstream convention or
+// removed textures) fall back to the font atlas, instead of being dereferenced.
+const Texture& ResolveTexture(ImTextureID tex_id) {
+    const Texture* tex = static_cast<const Texture*>(tex_id);
+    if (tex && tex != g_ctx.font_tex.get()) {
+        const auto it = g_ctx.textures.find(tex);
+        if (it != g_ctx.textures.end()) {
+            return *it->second;
+        }
+    }
+    return *g_ctx.font_tex;
+}
+
+ImVec2 RemapUv(const Texture& tex, const ImVec2& uv) {
+    return {uv.x * tex.uv_scale.x + tex.uv_offset.x,
+            uv.y * tex.uv_scale.y + tex.uv_offset.y};
+}
+
+// Lowest position for a `w` x `h` rectangle on the skyline
+bool FindSkylinePos(const std::vector<SkylineNode>& skyline, uint32_t w,
+                    uint32_t h, size_t& dst_idx, uint32_t& dst_x,
+                    uint32_t& dst_y) {
+    bool is_found = false;
+    for (size_t i = 0; i < skyline.size(); i++) {
+        const uint32_t x = skyline[i].x;
+        if (ATLAS_PAGE_SIZE < x + w) {
+            break;  // Nodes are sorted by x
+        }
+        // Rests on the highest node under the rectangle
+        uint32_t y = 0;
+        for (size_t j = i; j < skyline.size() && skyline[j].x < x + w; j++) {
+            y = std::max(y, skyline[j].y);
+        }
+        if (ATLAS_PAGE_SIZE < y + h || (is_found && dst_y <= y)) {
+            continue;
+        }
+        is_found = true;
+        dst_idx = i;
+        dst_x = x;
+        dst_y = y;
+    }
+    return is_found;
+}
+
+// Raises the skyline over a rectangle placed by `FindSkylinePos`
+void AddSkylineLevel(std::vector<SkylineNode>& skyline, size_t idx,
+                     uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+    const auto idx_it = skyline.begin() + static_cast<std::ptrdiff_t>(idx);
+    skyline.insert(idx_it, SkylineNode{x, y + h, w});
+
+    // Shrink or remove nodes covered by the new one
+    const uint32_t right = x + w;
+    size_t i = idx + 1;
+    while (i < skyline.size() && skyline[i].x < right) {
+        const uint32_t node_right = skyline[i].x + skyline[i].width;
+        if (right < node_right) {
+            skyline[i].width = node_right - right;
+            skyline[i].x = right;
+            break;
+        }
+        skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    // Merge neighbors of the same height
+    for (i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i + 1));
+        } else {
+            i++;
+        }
+    }
+}
+
+AtlasPagePtr CreateAtlasPage(const vk::Extent2D& size, bool is_shared) {
+    auto page = std::make_shared<AtlasPage>();
+    page->img = CreatePooledImage(vk::Format::eR8G8B8A8Unorm, size,
+                                  vk::ImageUsageFlagBits::eSampled |
+                                          vk::ImageUsageFlagBits::eTransferDst);
+    page->desc_set =
+            CreateTexDescSet(g_ctx.font_sampler.get(), page->img->view.get(),
+                             vk::ImageLayout::eShaderReadOnlyOptimal);
+    if (is_shared) {
+        page->skyline.push_back({0, 0, size.width});
+    }
+    return page;
+}
+
+// Copies RGBA pixels into a staging buffer with edges replicated by `padding`
+PooledBufferPtr CreatePaddedStaging(const uint8_t* rgba, uint32_t w,
+                                    uint32_t h, uint32_t padding) {
+    const uint32_t padded_w = w + padding * 2;
+    const uint32_t padded_h = h + padding * 2;
+    const size_t row_bytes = static_cast<size_t>(w) * 4;
+    auto buf = CreatePooledBuffer(
+            static_cast<size_t>(padded_w) * padded_h * 4,
+            vk::BufferUsageFlagBits::eTransferSrc, vkw::HOST_VISIB_COHER_PROPS);
+    uint8_t* dst_p = buf->mem.mapped_p;
+    for (uint32_t y = 0; y < padded_h; y++) {
+        const uint32_t src_y = std::min(std::max(y, padding), h + padding - 1);
+        const uint8_t* src_row = rgba + (src_y - padding) * row_bytes;
+        for (uint32_t x = 0; x < padding; x++) {
+            memcpy(dst_p, src_row, 4);
+            dst_p += 4;
+        }
+        memcpy(dst_p, src_row, row_bytes);
+        dst_p += row_bytes;
+        for (uint32_t x = 0; x < padding; x++) {
+            memcpy(dst_p, src_row + row_bytes - 4, 4);
+            dst_p += 4;
+        }
+    }
+    return buf;
+}
+
+// Places an image into a shared page (A new page is opened when all are full)
+TexturePtr PackAtlasEntry(const uint8_t* rgba, uint32_t w, uint32_t h) {
+    const uint32_t padded_w = w + ATLAS_PADDING * 2;
+    const uint32_t padded_h = h + ATLAS_PADDING * 2;
+    AtlasPagePtr page;
+    size_t idx = 0;
+    uint32_t x = 0, y = 0;
+    for (auto&& open_page : g_ctx.atlas_pages) {
+        if (FindSkylinePos(open_page->skyline, padded_w, padded_h, idx, x,
+                           y)) {
+            page = open_page;
+            break;
+        }
+    }
+    if (!page) {
+        page = CreateAtlasPage({ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE}, true);
+        g_ctx.atlas_pages.push_back(page);
+        FindSkylinePos(page->skyline, padded_w, padded_h, idx, x, y);
+    }
+    AddSkylineLevel(page->skyline, idx, x, y, padded_w, padded_h);
+
+    page->uploads.push_back(
+            {CreatePaddedStaging(rgba, w, h, ATLAS_PADDING),
+             {static_cast<int32_t>(x), static_cast<int32_t>(y)},
+             {padded_w, padded_h}});
+    auto tex = std::make_shared<Texture>();
+    tex->desc_set = page->desc_set;
+    tex->page = page;
+    tex->is_atlas_entry = true;
+    const float page_size = static_cast<float>(ATLAS_PAGE_SIZE);
+    tex->uv_scale = {static_cast<float>(w) / page_size,
+                     static_cast<float>(h) / page_size};
+    tex->uv_offset = {static_cast<float>(x + ATLAS_PADDING) / page_size,
+                      static_cast<float>(y + ATLAS_PADDING) / page_size};
+    return tex;
+}
+
+void MarkDirty(const AtlasPagePtr& page) {
+    auto& dirty_pages = g_ctx.dirty_pages;
+    if (std::find(dirty_pages.begin(), dirty_pages.end(), page) ==
+        dirty_pages.end()) {
+        dirty_pages.push_back(page);
+    }
+}
+
+// Copies pending pixels into pages, which are left for sampling
+void UploadAtlasPages(const vk::UniqueCommandBuffer& dst_cmd_buf) {
+    const vk::ImageSubresourceRange subres_range = {
+            vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+    for (auto&& page : g_ctx.dirty_pages) {
+        // Waits for samplings of previous frames (Packed areas are kept)
+        const vk::ImageMemoryBarrier to_transfer = {
+                {},
+                vk::AccessFlagBits::eTransferWrite,
+                page->is_initialized ? vk::ImageLayout::eShaderReadOnlyOptimal :
+                                       vk::ImageLayout::eUndefined,
+                vk::ImageLayout::eTransferDstOptimal,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                page->img->img.get(),
+                subres_range};
+        dst_cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader,
+                                     vk::PipelineStageFlagBits::eTransfer, {},
+                                     nullptr, nullptr, to_transfer);
+        for (auto&& upload : page->uploads) {
+            const vk::BufferImageCopy region = {
+                    0,
+                    0,
+                    0,
+                    {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+                    {upload.offset.x, upload.offset.y, 0},
+                    {upload.size.width, upload.size.height, 1}};
+            dst_cmd_buf->copyBufferToImage(
+                    upload.buf->buf.get(), page->img->img.get(),
+                    vk::ImageLayout::eTransferDstOptimal, region);
+            g_ctx.frame_stats.uploaded_bytes += upload.buf->mem.size;
+            // Staging is used by this frame
+            Retire(std::move(upload.buf), g_ctx.frame_idx);
+        }
+        page->uploads.clear();
+        page->is_initialized = true;
+
+        const vk::ImageMemoryBarrier to_shader = {
+                vk::AccessFlagBits::eTransferWrite,
+                vk::AccessFlagBits::eShaderRead,
+                vk::ImageLayout::eTransferDstOptimal,
+                vk::ImageLayout::eShaderReadOnlyOptimal,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                page->img->img.get(),
+                subres_range};
+        dst_cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                     vk::PipelineStageFlagBits::eFragmentShader,
+                                     {}, nullptr, nullptr, to_shader);
+    }
+    g_ctx.dirty_pages.clear();
+}
+
+// Copies written slots of streaming textures with one barrier before and
+// after all copies. (Nothing is allocated once the barrier vector has grown)
+void UploadStreamingTexs(const vk::UniqueCommandBuffer& dst_cmd_buf) {
+    auto& stats = g_ctx.frame_stats;
+    auto& barriers = g_ctx.stream_barriers;
+    const vk::ImageSubresourceRange subres_range = {
+            vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+    barriers.clear();
+    for (auto&& stream : g_ctx.streaming_texs) {
+        if (stream->pending_idx == NO_SLOT && stream->is_initialized) {
+            continue;
+        }
+        // Waits for samplings of previous frames
+        barriers.push_back({{},
+                            vk::AccessFlagBits::eTransferWrite,
+                            stream->is_initialized ?
+                                    vk::ImageLayout::eShaderReadOnlyOptimal :
+                                    vk::ImageLayout::eUndefined,
+                            vk::ImageLayout::eTransferDstOptimal,
+                            VK_QUEUE_FAMILY_IGNORED,
+                            VK_QUEUE_FAMILY_IGNORED,
+                            stream->img->img.get(),
+                            subres_range});
+    }
+    if (barriers.empty()) {
+        return;
+    }
+    dst_cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader,
+                                 vk::PipelineStageFlagBits::eTransfer, {},
+                                 nullptr, nullptr, barriers);
+
+    for (auto&& stream : g_ctx.streaming_texs) {
+        if (stream->pending_idx == NO_SLOT) {
+            if (!stream->is_initialized) {
+                // Not written yet -> Transparent
+                stream->is_initialized = true;
+                dst_cmd_buf->clearColorImage(
+                        stream->img->img.get(),
+                        vk::ImageLayout::eTransferDstOptimal,
+                        vk::ClearColorValue(
+                                std::array<float, 4>{{0.f, 0.f, 0.f, 0.f}}),
+                        subres_range);
+            }
+            continue;
+        }
+        auto& slot = stream->slots[stream->pending_idx];
+        const vk::BufferImageCopy region = {
+                0,
+                0,
+                0,
+                {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+                {0, 0, 0},
+                {stream->img->size.width, stream->img->size.height, 1}};
+        dst_cmd_buf->copyBufferToImage(slot.buf->buf.get(),
+                                       stream->img->img.get(),
+                                       vk::ImageLayout::eTransferDstOptimal,
+                                       region);
+        slot.frame_idx = g_ctx.frame_idx;
+        stream->pending_idx = NO_SLOT;
+        stream->is_initialized = true;
+        stats.uploaded_bytes += slot.buf->mem.size;
+        stats.n_tex_updates++;
+    }
+
+    for (auto&& barrier : barriers) {
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+        barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+        barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    }
+    dst_cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                 vk::PipelineStageFlagBits::eFragmentShader,
+                                 {}, nullptr, nullptr, barriers);
+}
+
+// -----------------------------------------------------------------------------
+// ---------------------------- GPU Timing Utility -----------------------------
+// -----------------------------------------------------------------------------
+bool PrepareGpuTiming() {
+    auto& timing = g_ctx.gpu_timing;
+    if (timing.query_pool) {
+        return true;  // Already created
+    }
+
+    // Check support
+    auto&& physical_device = *g_ctx.physical_device_p;
+    auto&& device = *g_ctx.device_p;
+    const auto& limits = physical_device.getProperties().limits;
+    if (!limits.timestampComputeAndGraphics) {
+        return false;
+    }
+    // Recording queue is unknown, so the fewest bits of graphic queues
+    uint32_t n_valid_bits = 64;
+    for (auto&& props : physical_device.getQueueFamilyProperties()) {
+        if (props.queueFlags & vk::QueueFlagBits::eGraphics) {
+            n_valid_bits = std::min(n_valid_bits, props.timestampValidBits);
+        }
+    }
+    if (n_valid_bits == 0) {
+        return false;
+    }
+
+    // Create query pool for all frames in flight
+    timing.timestamp_period_ns = limits.timestampPeriod;
+    timing.timestamp_mask = (n_valid_bits < 64) ?
+                                    (uint64_t{1} << n_valid_bits) - 1 :
+                                    UINT64_MAX;
+    timing.query_pool = device->createQueryPoolUnique(
+            {{}, vk::QueryType::eTimestamp,
+             N_TIMESTAMPS * N_TIMESTAMP_FRAMES});
+    timing.is_pending = {};
+    return true;
+}
+
+void ResolveGpuTiming() {
+    // Collect only finished queries (Never waits for GPU)
+    auto& timing = g_ctx.gpu_timing;
+    auto&& device = *g_ctx.device_p;
+    for (uint32_t slot = 0; slot < N_TIMESTAMP_FRAMES; slot++) {
+        if (!timing.is_pending[slot]) {
+            continue;
+        }
+        // Pairs of (timestamp, availability)
+        std::array<uint64_t, N_TIMESTAMPS * 2> results = {};
+        const auto ret = device->getQueryPoolResults(
+                timing.query_pool.get(), slot * N_TIMESTAMPS, N_TIMESTAMPS,
+                sizeof(results), results.data(), sizeof(uint64_t) * 2,
+                vk::QueryResultFlagBits::e64 |
+                        vk::QueryResultFlagBits::eWithAvailability);
+        if (ret != vk::Result::eSuccess && ret != vk::Result::eNotReady) {
+            timing.is_pending[slot] = false;
+            continue;
+        }
+        bool is_available = true;
+        for (uint32_t i = 0; i < N_TIMESTAMPS; i++) {
+            is_available &= (results[i * 2 + 1] != 0);
+        }
+        if (!is_available) {
+            continue;
+        }
+        timing.is_pending[slot] = false;
+
+        auto to_ms = [&](TimestampIdx begin, TimestampIdx end) {
+            // Wraps around within the valid bits
+            const uint64_t ticks =
+                    (results[end * 2] - results[begin * 2]) &
+                    timing.timestamp_mask;
+            return static_cast<float>(static_cast<double>(ticks) *
+                                      timing.timestamp_period_ns * 1e-6);
+        };
+        timing.bg_samples.push(to_ms(TIMESTAMP_BEGIN, TIMESTAMP_BG_END));
+        timing.imgui_samples.push(to_ms(TIMESTAMP_BG_END, TIMESTAMP_IMGUI_END));
+        timing.total_samples.push(to_ms(TIMESTAMP_BEGIN, TIMESTAMP_IMGUI_END));
+    }
+}
+
+// Returns the first query index of the current frame, or UINT32_MAX
+uint32_t BeginGpuTiming(const vk::UniqueCommandBuffer& dst_cmd_buf) {
+    if (!g_ctx.options.gpu_timing || !PrepareGpuTiming()) {
+        return UINT32_MAX;
+    }
+    ResolveGpuTiming();
+
+    // Queries of the reused slot are dropped when they are not finished yet
+    auto& timing = g_ctx.gpu_timing;
+    const uint32_t slot =
+            static_cast<uint32_t>(timing.n_frames++ % N_TIMESTAMP_FRAMES);
+    timing.is_pending[slot] = true;
+    const uint32_t query_base = slot * N_TIMESTAMPS;
+    dst_cmd_buf->resetQueryPool(timing.query_pool.get(), query_base,
+                                N_TIMESTAMPS);
+    return query_base;
+}
+
+void WriteGpuTimestamp(const vk::UniqueCommandBuffer& dst_cmd_buf,
+                       uint32_t query_base, TimestampIdx idx,
+                       vk::PipelineStageFlagBits stage) {
+    if (query_base == UINT32_MAX) {
+        return;  // Disabled
+    }
+    dst_cmd_buf->writeTimestamp(stage, g_ctx.gpu_timing.query_pool.get(),
+                                query_base + idx);
+}
+
+ImGui_ImplVulkanHpp_GpuTimingStat SummarizeTiming(
+        const TimingSamples& samples) {
+    ImGui_ImplVulkanHpp_GpuTimingStat stat;
+    if (samples.n_values == 0) {
+        return stat;
+    }
+    std::array<float, N_TIMING_SAMPLES> sorted = samples.values_ms;
+    const auto sorted_end =
+            sorted.begin() + static_cast<std::ptrdiff_t>(samples.n_values);
+    std::sort(sorted.begin(), sorted_end);
+    auto percentile = [&](float p) {
+        const float pos = p * static_cast<float>(samples.n_values - 1);
+        return sorted[static_cast<size_t>(pos + 0.5f)];
+    };
+    float sum = 0.f;
+    for (auto it = sorted.begin(); it != sorted_end; it++) {
+        sum += *it;
+    }
+    stat.avg_ms = sum / static_cast<float>(samples.n_values);
+    stat.p50_ms = percentile(0.50f);
+    stat.p95_ms = percentile(0.95f);
+    stat.p99_ms = percentile(0.99f);
+    stat.max_ms = sorted[samples.n_values - 1];
+    return stat;
+}
+
+// -----------------------------------------------------------------------------
+// ------------------------------- ImGui Utility -------------------------------
+// -----------------------------------------------------------------------------
+ImVec2 ObtainImDrawSize(ImDrawData* draw_data) {
+    auto fb_width_f = draw_data->DisplaySize.x * draw_data->FramebufferScale.x;
+    auto fb_height_f = draw_data->DisplaySize.y * draw_data->FramebufferScale.y;
+    return {fb_width_f, fb_height_f};
+}
+
+// Vertices must be checked by `FitsCompactVerts` in advance
+int16_t QuantizePos(float v, float origin) {
+    return static_cast<int16_t>(std::lround((v - origin) * COMPACT_POS_SCALE));
+}
+
+uint16_t QuantizeUv(float v) {
+    v = std::min(std::max(v, 0.f), 1.f);  // Rounding errors of atlas remaps
+    return static_cast<uint16_t>(v * COMPACT_UV_SCALE + 0.5f);
+}
+
+// Whether vertices are representable without moving or clamping them
+bool FitsCompactVerts(const ImDrawVert* src, int n_vtxs,
+                      const ImVec2& origin) {
+    for (int i = 0; i < n_vtxs; i++) {
+        const ImDrawVert& v = src[i];
+        if (!(std::abs(v.pos.x - origin.x) <= COMPACT_POS_MAX &&
+              std::abs(v.pos.y - origin.y) <= COMPACT_POS_MAX &&
+              0.f <= v.uv.x && v.uv.x <= 1.f && 0.f <= v.uv.y &&
+              v.uv.y <= 1.f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CopyCompactVerts(uint8_t* dst_p, const ImDrawVert* src, int n_vtxs,
+                      const ImVec2& origin) {
+    CompactVert* dst = reinterpret_cast<CompactVert*>(dst_p);
+    for (int i = 0; i < n_vtxs; i++) {
+        dst[i].pos[0] = QuantizePos(src[i].pos.x, origin.x);
+        dst[i].pos[1] = QuantizePos(src[i].pos.y, origin.y);
+        dst[i].uv[0] = QuantizeUv(src[i].uv.x);
+        dst[i].uv[1] = QuantizeUv(src[i].uv.y);
+        dst[i].col = src[i].col;
+    }
+}
+
+// Compact format of the option, if the whole frame fits it
+ImGui_ImplVulkanHpp_VertexFormat SelectVtxFormat(const ImDrawData* draw_data,
+                                                 bool instanced_quads) {
+    using VertexFormat = ImGui_ImplVulkanHpp_VertexFormat;
+    if (g_ctx.options.vertex_format != VertexFormat::Compact) {
+        return VertexFormat::Float;
+    }
+    const ImVec2& origin = draw_data->DisplayPos;
+    if (instanced_quads) {
+        const auto& vtxs = g_ctx.quad_packing.vtxs;
+        return FitsCompactVerts(vtxs.data(), static_cast<int>(vtxs.size()),
+                                origin) ?
+                       VertexFormat::Compact :
+                       VertexFormat::Float;
+    }
+    for (int n = 0; n < draw_data->CmdListsCount; n++) {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        if (!FitsCompactVerts(cmd_list->VtxBuffer.Data,
+                              cmd_list->VtxBuffer.Size, origin)) {
+            return VertexFormat::Float;  // e.g. Off-screen or repeated UVs
+        }
+    }
+    return VertexFormat::Compact;
+}
+
+// Remaps UVs of atlas entries in the uploaded vertices of `cmd_list`
+void RemapListUvs(uint8_t* dst_p, const ImDrawList* cmd_list,
+                  ImGui_ImplVulkanHpp_VertexFormat vtx_format) {
+    const bool is_compact =
+            (vtx_format == ImGui_ImplVulkanHpp_VertexFormat::Compact);
+    auto& is_remapped = g_ctx.uv_remapped;
+    bool is_cleared = false;
+    for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++) {
+        const ImDrawCmd& cmd = cmd_list->CmdBuffer[cmd_i];
+        if (cmd.UserCallback != nullptr || cmd.ElemCount == 0) {
+            continue;
+        }
+        const Texture& tex = ResolveTexture(cmd.TextureId);
+        if (!tex.is_atlas_entry) {
+            continue;
+        }
+        if (!is_cleared) {
+            // Only for lists with atlas entries
+            is_remapped.assign(static_cast<size_t>(cmd_list->VtxBuffer.Size),
+                               0);
+            is_cleared = true;
+        }
+        // Only indexed vertices. (Channels of `ImDrawListSplitter` interleave
+        // vertices of other commands within the index range)
+        const ImDrawIdx* idxs = cmd_list->IdxBuffer.Data + cmd.IdxOffset;
+        for (uint32_t k = 0; k < cmd.ElemCount; k++) {
+            const uint32_t i = cmd.VtxOffset + idxs[k];
+            if (is_remapped[i]) {
+                continue;
+            }
+            is_remapped[i] = 1;
+            const ImVec2 uv = RemapUv(tex, cmd_list->VtxBuffer.Data[i].uv);
+            if (is_compact) {
+                CompactVert& dst = reinterpret_cast<CompactVert*>(dst_p)[i];
+                dst.uv[0] = QuantizeUv(uv.x);
+                dst.uv[1] = QuantizeUv(uv.y);
+            } else {
+                reinterpret_cast<ImDrawVert*>(dst_p)[i].uv = uv;
+            }
+        }
+    }
+}
+
+// Detects an axis-aligned quad written by `ImDrawList::PrimRectUV`
+// (Indices: a, b, c, a, c, d / Corners: TL, TR, BR, BL)
+bool IsAxisAlignedQuad(const ImDrawVert* vtxs, uint32_t n_vtxs,
+                       const ImDrawIdx* idxs) {
+    auto idx = [&](int k) { return static_cast<uint32_t>(idxs[k]); };
+    const uint32_t i0 = idx(0);
+    if (idx(1) != i0 + 1 || idx(2) != i0 + 2 || idx(3) != i0 ||
+        idx(4) != i0 + 2 || idx(5) != i0 + 3 || n_vtxs <= i0 + 3) {
+        return false;
+    }
+    const ImDrawVert& a = vtxs[i0];
+    const ImDrawVert& b = vtxs[i0 + 1];
+    const ImDrawVert& c = vtxs[i0 + 2];
+    const ImDrawVert& d = vtxs[i0 + 3];
+    return a.pos.y == b.pos.y && b.pos.x == c.pos.x && c.pos.y == d.pos.y &&
+           d.pos.x == a.pos.x && a.uv.y == b.uv.y && b.uv.x == c.uv.x &&
+           c.uv.y == d.uv.y && d.uv.x == a.uv.x && a.col == b.col &&
+           a.col == c.col && a.col == d.col;
+}
+
+// True if quads of `pcmd` can be appended to `run` (Same clip rect and
+// descriptor set)
+bool CanContinueQuads(const PackedCmd& run, const ImDrawCmd* pcmd,
+                      const Texture& tex) {
+    if (!run.is_quads || run.pcmd->UserCallback != nullptr) {
+        return false;
+    }
+    const ImVec4& a = run.pcmd->ClipRect;
+    const ImVec4& b = pcmd->ClipRect;
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w &&
+           ResolveTexture(run.pcmd->TextureId).desc_set == tex.desc_set;
+}
+
+// Splits draw commands into runs of instanced quads and indexed triangles
+void PackQuads(ImDrawData* draw_data) {
+    auto& packing = g_ctx.quad_packing;
+    packing.vtxs.clear();
+    packing.idxs.clear();
+    packing.quads.clear();
+    packing.cmds.clear();
+
+    for (int n = 0; n < draw_data->CmdListsCount; n++) {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        const ImDrawVert* src_vtxs = cmd_list->VtxBuffer.Data;
+        const uint32_t n_src_vtxs =
+                static_cast<uint32_t>(cmd_list->VtxBuffer.Size);
+        packing.vtx_remap.assign(n_src_vtxs, UINT32_MAX);
+
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++) {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            if (pcmd->UserCallback != nullptr) {
+                packing.cmds.emplace_back();
+                packing.cmds.back().cmd_list = cmd_list;
+                packing.cmds.back().pcmd = pcmd;
+                continue;
+            }
+            // Icons of one atlas page continue the last run of quads
+            const Texture& tex = ResolveTexture(pcmd->TextureId);
+            PackedCmd* run = nullptr;
+            if (!packing.cmds.empty() &&
+                CanContinueQuads(packing.cmds.back(), pcmd, tex)) {
+                run = &packing.cmds.back();
+            }
+
+            // Packed vertices are addressed from the base of each command
+            const uint32_t vtx_base =
+                    static_cast<uint32_t>(packing.vtxs.size());
+            const ImDrawVert* cmd_vtxs = src_vtxs + pcmd->VtxOffset;
+            const uint32_t n_cmd_vtxs = n_src_vtxs - pcmd->VtxOffset;
+            const ImDrawIdx* cmd_idxs =
+                    cmd_list->IdxBuffer.Data + pcmd->IdxOffset;
+            uint32_t k = 0;
+            while (k < pcmd->ElemCount) {
+                const bool is_quad =
+                        k + 6 <= pcmd->ElemCount &&
+                        IsAxisAlignedQuad(cmd_vtxs, n_cmd_vtxs, cmd_idxs + k);
+                if (!run || run->is_quads != is_quad) {
+                    // Start new run
+                    packing.cmds.emplace_back();
+                    run = &packing.cmds.back();
+                    run->cmd_list = cmd_list;
+                    run->pcmd = pcmd;
+                    run->is_quads = is_quad;
+                    run->first = static_cast<uint32_t>(
+                            is_quad ? packing.quads.size() :
+                                      packing.idxs.size());
+                    run->vtx_offset = static_cast<int32_t>(vtx_base);
+                }
+                if (is_quad) {
+                    const ImDrawVert& tl = cmd_vtxs[cmd_idxs[k]];
+                    const ImDrawVert& br = cmd_vtxs[cmd_idxs[k + 2]];
+                    const ImVec2 tl_uv =
+                            tex.is_atlas_entry ? RemapUv(tex, tl.uv) : tl.uv;
+                    const ImVec2 br_uv =
+                            tex.is_atlas_entry ? RemapUv(tex, br.uv) : br.uv;
+                    packing.quads.push_back(
+                            {{tl.pos.x, tl.pos.y, br.pos.x, br.pos.y},
+                             {tl_uv.x, tl_uv.y, br_uv.x, br_uv.y},
+                             tl.col});
+                    run->count++;
+                    k += 6;
+                    continue;
+                }
+                for (uint32_t j = k; j < k + 3; j++) {
+                    // Copy each vertex once per command
+                    const uint32_t src_idx = pcmd->VtxOffset + cmd_idxs[j];
+                    uint32_t& dst_idx = packing.vtx_remap[src_idx];
+                    if (dst_idx == UINT32_MAX || dst_idx < vtx_base) {
+                        dst_idx = static_cast<uint32_t>(packing.vtxs.size());
+                        packing.vtxs.push_back(src_vtxs[src_idx]);
+                        if (tex.is_atlas_entry) {
+                            ImVec2& uv = packing.vtxs.back().uv;
+                            uv = RemapUv(tex, uv);
+                        }
+                    }
+                    packing.idxs.push_back(
+                            static_cast<ImDrawIdx>(dst_idx - vtx_base));
+                }
+                run->count += 3;
+                k += 3;
+            }
+        }
+    }
+}
+
+void WritePlotBuf(const ImGui_ImplVulkanHpp_PlotDesc& desc, uint8_t* dst_p) {
+    const ImVec4 col = ImGui::ColorConvertU32ToFloat4(desc.col);
+    const float value_range = desc.value_max - desc.value_min;
+    PlotBuf plot_buf;
+    plot_buf.rect_min[0] = desc.rect_min.x;
+    plot_buf.rect_min[1] = desc.rect_min.y;
+    plot_buf.rect_size[0] = desc.rect_max.x - desc.rect_min.x;
+    plot_buf.rect_size[1] = desc.rect_max.y - desc.rect_min.y;
+    plot_buf.value_min = desc.value_min;
+    plot_buf.value_scale = (value_range != 0.f) ? 1.f / value_range : 0.f;
+    plot_buf.thickness = desc.thickness;
+    plot_buf.n_samples = desc.n_samples;
+    plot_buf.col[0] = col.x;
+    plot_buf.col[1] = col.y;
+    plot_buf.col[2] = col.z;
+    plot_buf.col[3] = col.w;
+    memcpy(dst_p, &plot_buf, sizeof(PlotBuf));
+}
+
+bool UpdateVtxIdxBufs(ImDrawData* draw_data) {
+    auto& stats = g_ctx.frame_stats;
+
+    // Quads are extracted beforehand
+    const bool instanced_quads = g_ctx.options.instanced_quads;
+    g_ctx.instanced_quads = instanced_quads;
+    const auto& packing = g_ctx.quad_packing;
+    if (instanced_quads) {
+        PackQuads(draw_data);
+    }
+
+    // Sizes of this frame
+    const auto vtx_format = SelectVtxFormat(draw_data, instanced_quads);
+    g_ctx.vtx_format = vtx_format;
+    const size_t vtx_stride = GetVtxStride(vtx_format);
+    const size_t n_vtxs = instanced_quads ?
+                                  packing.vtxs.size() :
+                                  static_cast<size_t>(draw_data->TotalVtxCount);
+    const size_t n_idxs = instanced_quads ?
+                                  packing.idxs.size() :
+                                  static_cast<size_t>(draw_data->TotalIdxCount);
+    const size_t n_quads = instanced_quads ? packing.quads.size() : 0;
+    const size_t vtx_size = n_vtxs * vtx_stride;
+    const size_t idx_size = n_idxs * sizeof(ImDrawIdx);
+    const size_t quad_size = n_quads * sizeof(QuadInst);
+    if (idx_size == 0 && quad_size == 0) {
+        return false;  // Failed
+    }
+    const size_t unif_align = g_ctx.min_unif_offset_align;
+    const size_t vtx_align =
+            std::max(g_ctx.min_storage_offset_align, sizeof(uint32_t));
+    const size_t idx_align = sizeof(ImDrawIdx);
+
+    const size_t plot_align = g_ctx.min_storage_offset_align;
+    const size_t n_plots = g_ctx.plot_descs.size();
+
+    // Reserve whole frame at once, then bump-allocate each region
+    // (Vertices take the whole bound range of the descriptor)
+    Arena& arena = AcquireArena();
+    ReserveArenaVtxRange(arena, vtx_size);
+    const size_t frame_size = unif_align + sizeof(UnifBuf) + vtx_align +
+                              arena.vtx_range + idx_align + idx_size +
+                              sizeof(float) + quad_size +
+                              n_plots * (plot_align + sizeof(PlotBuf));
+    ReserveArena(arena, frame_size);
+    ResetArena(arena);
+    arena.unif_offset = AllocArena(arena, sizeof(UnifBuf), unif_align);
+    arena.vtx_offset = AllocArena(arena, arena.vtx_range, vtx_align);
+    arena.idx_offset = AllocArena(arena, idx_size, idx_align);
+    arena.quad_offset = AllocArena(arena, quad_size, sizeof(float));
+    g_ctx.plot_offsets.resize(n_plots);
+    for (size_t i = 0; i < n_plots; i++) {
+        g_ctx.plot_offsets[i] = AllocArena(arena, sizeof(PlotBuf), plot_align);
+        WritePlotBuf(g_ctx.plot_descs[i],
+                     arena.mapped_p + g_ctx.plot_offsets[i]);
+    }
+
+    // Send vertex/index data to GPU (TODO: Async)
+    uint8_t* vtx_dst = arena.mapped_p + arena.vtx_offset;
+    uint8_t* idx_dst = arena.mapped_p + arena.idx_offset;
+    if (instanced_quads) {
+        if (vtx_format == ImGui_ImplVulkanHpp_VertexFormat::Compact) {
+            CopyCompactVerts(vtx_dst, packing.vtxs.data(),
+                             static_cast<int>(n_vtxs), draw_data->DisplayPos);
+        } else {
+            memcpy(vtx_dst, packing.vtxs.data(), vtx_size);
+        }
+        memcpy(idx_dst, packing.idxs.data(), idx_size);
+        memcpy(arena.mapped_p + arena.quad_offset, packing.quads.data(),
+               quad_size);
+    }
+    for (int n = 0; !instanced_quads && n < draw_data->CmdListsCount; n++) {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        const size_t vtx_n_bytes =
+                static_cast<size_t>(cmd_list->VtxBuffer.Size) * vtx_stride;
+        const size_t idx_n_bytes =
+                static_cast<size_t>(cmd_list->IdxBuffer.Size) *
+                sizeof(ImDrawIdx);
+        if (vtx_format == ImGui_ImplVulkanHpp_VertexFormat::Compact) {
+            // Convert during the copy
+            CopyCompactVerts(vtx_dst, cmd_list->VtxBuffer.Data,
+                             cmd_list->VtxBuffer.Size, draw_data->DisplayPos);
+        } else {
+            memcpy(vtx_dst, cmd_list->VtxBuffer.Data, vtx_n_bytes);
+        }
+        // Draw data is left as it is
+        RemapListUvs(vtx_dst, cmd_list, vtx_format);
+        memcpy(idx_dst, cmd_list->IdxBuffer.Data, idx_n_bytes);
+        vtx_dst += vtx_n_bytes;
+        idx_dst += idx_n_bytes;
+    }
+    stats.n_vtxs_uploaded += static_cast<uint32_t>(n_vtxs);
+    stats.n_idxs_uploaded += static_cast<uint32_t>(n_idxs);
+    stats.n_quads_instanced += static_cast<uint32_t>(n_quads);
+    stats.uploaded_bytes += vtx_size + idx_size + quad_size;
+
+    return true;
+}
+
+void UpdateFontTex(const vk::UniqueCommandBuffer& dst_cmd_buf) {
+    if (g_ctx.is_font_tex_sent) {
+        // Release transferring resources
+        Retire(std::move(g_ctx.font_buf));
+
+        return;  // Already created
+    }
+    g_ctx.is_font_tex_sent = true;
+
+    // Create transferring buffer
+    g_ctx.font_buf = CreatePooledBuffer(g_ctx.font_pixel_size,
+                                        vk::BufferUsageFlagBits::eTransferSrc,
+                                        vkw::HOST_VISIB_COHER_PROPS);
+
+    // Send from CPU to buffer (TODO: Async)
+    memcpy(g_ctx.font_buf->mem.mapped_p, g_ctx.font_pixel_p,
+           g_ctx.font_pixel_size);
+    g_ctx.frame_stats.uploaded_bytes += g_ctx.font_pixel_size;
+
+    // Copy from buffer to image
+    CmdUploadImage(dst_cmd_buf, g_ctx.font_buf, g_ctx.font_img);
+}
+
+vkw::RenderPassPackPtr CreateRenderPass(const vk::Format& dst_img_format,
+                                        const vk::ImageLayout& dst_init_layout,
+                                        const vk::ImageLayout& dst_final_layout,
+                                        bool has_bg,
+                                        const vk::AttachmentLoadOp& load_op) {
+    auto&& device = *g_ctx.device_p;
+
+    // Create render pass
+    auto render_pass_pack = vkw::CreateRenderPassPack();
+    // Add color attachment
+    vkw::AddAttachientDesc(render_pass_pack, dst_img_format,
+                           dst_init_layout, dst_final_layout, load_op,
+                           vk::AttachmentStoreOp::eStore);
+    // Add subpass
+    if (has_bg) {
+        vkw::AddSubpassDesc(render_pass_pack, {},
+                            {{0, vk::ImageLayout::eColorAttachmentOptimal}});
+        vkw::AddSubpassDepend(
+                render_pass_pack,
+                {0, vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                 vk::AccessFlagBits::eColorAttachmentWrite},
+                {1, vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                 vk::AccessFlagBits::eColorAttachmentRead},
+                vk::DependencyFlagBits::eByRegion);
+    }
+    vkw::AddSubpassDesc(render_pass_pack, {},
+                        {{0, vk::ImageLayout::eColorAttachmentOptimal}});
+    // Create render pass instance
+    vkw::UpdateRenderPass(device, render_pass_pack);
+    return render_pass_pack;
+}
+
+// Render passes are cheap, so they are always created synchronously
+// (Initial layout does not affect the compatibility of pipelines)
+const vkw::RenderPassPackPtr& ObtainRenderPass(
+        const vk::Format& dst_img_format,
+        const vk::ImageLayout& dst_init_layout,
+        const vk::ImageLayout& dst_final_layout, bool has_bg) {
+    const RenderPassKey key = {dst_img_format, dst_init_layout,
+                               dst_final_layout, has_bg};
+    auto& render_pass_pack = g_ctx.render_pass_cache[key];
+    if (!render_pass_pack) {
+        render_pass_pack = CreateRenderPass(dst_img_format, dst_init_layout,
+                                            dst_final_layout, has_bg,
+                                            vk::AttachmentLoadOp::eLoad);
+        g_ctx.frame_stats.n_render_pass_rebuilds++;
+    }
+    return render_pass_pack;
+}
+
+// Does not touch the global context (Called from background threads)
+PipelineSetPtr BuildPipelineSet(const PipelineBuildInfo& info) {
+    IMGUI_IMPL_VULKANHPP_TRACE_ZONE("BuildPipelineSet");
+    auto&& device = *info.device_p;
+    auto pipeline_set = std::make_shared<PipelineSet>();
+
+    // Create pipeline (ImGui)
+    // Into the overlay target only, coverage accumulates in alpha for the
+    // premultiplied composite. (Alpha written to user targets is unchanged)
+    const bool has_overlay = static_cast<bool>(info.dst_render_pass_pack);
+    vkw::PipelineColorBlendAttachInfo imgui_pipeine_blend_info;
+    imgui_pipeine_blend_info.blend_enable = true;
+    if (has_overlay) {
+        imgui_pipeine_blend_info.blend_src_alpha_factor =
+                vk::BlendFactor::eOne;
+    }
+    vkw::PipelineInfo imgui_pipeline_info;
+    imgui_pipeline_info.color_blend_infos = {imgui_pipeine_blend_info};
+    imgui_pipeline_info.depth_test_enable = false;
+    imgui_pipeline_info.face_culling = vk::CullModeFlagBits::eNone;
+
+    const uint32_t subpass_idx = info.has_bg ? 1 : 0;
+    const std::vector<vkw::DescSetPackPtr> imgui_desc_set_packs = {
+            info.imgui_desc_set_pack, info.tex_desc_set_pack};
+    const std::vector<vkw::ShaderModulePackPtr> imgui_shaders = {
+            info.imgui_vert_shader_pack, info.imgui_frag_shader_pack};
+    if (info.vtx_pulling) {
+        // No vertex input (Read from storage buffer)
+        pipeline_set->imgui_pipeline_pack = vkw::CreateGraphicsPipeline(
+                device, imgui_shaders, {}, {}, imgui_pipeline_info,
+                imgui_desc_set_packs, info.render_pass_pack,
+                subpass_idx);
+    } else if (info.vtx_format == ImGui_ImplVulkanHpp_VertexFormat::Compact) {
+        pipeline_set->imgui_pipeline_pack = vkw::CreateGraphicsPipeline(
+                device, imgui_shaders,
+                {{0, sizeof(CompactVert), vk::VertexInputRate::eVertex}},
+                {{0, 0, vk::Format::eR16G16Sint, offsetof(CompactVert, pos)},
+                 {1, 0, vk::Format::eR16G16Unorm, offsetof(CompactVert, uv)},
+                 {2, 0, vk::Format::eR8G8B8A8Unorm,
+                  offsetof(CompactVert, col)}},
+                imgui_pipeline_info, imgui_desc_set_packs,
+                info.render_pass_pack, subpass_idx);
+    } else {
+        pipeline_set->imgui_pipeline_pack = vkw::CreateGraphicsPipeline(
+                device, imgui_shaders,
+                {{0, sizeof(ImDrawVert), vk::VertexInputRate::eVertex}},
+                {{0, 0, vk::Format::eR32G32Sfloat, offsetof(ImDrawVert, pos)},
+                 {1, 0, vk::Format::eR32G32Sfloat, offsetof(ImDrawVert, uv)},
+                 {2, 0, vk::Format::eR8G8B8A8Unorm,
+                  offsetof(ImDrawVert, col)}},
+                imgui_pipeline_info, imgui_desc_set_packs,
+                info.render_pass_pack, subpass_idx);
+    }
+
+    if (info.instanced_quads) {
+        // Create pipeline (Instanced quads)
+        pipeline_set->quad_pipeline_pack = vkw::CreateGraphicsPipeline(
+                device,
+                {info.quad_vert_shader_pack, info.imgui_frag_shader_pack},
+                {{QUAD_BINDING, sizeof(QuadInst),
+                  vk::VertexInputRate::eInstance}},
+                {{0, QUAD_BINDING, vk::Format::eR32G32B32A32Sfloat,
+                  offsetof(QuadInst, rect)},
+                 {1, QUAD_BINDING, vk::Format::eR32G32B32A32Sfloat,
+                  offsetof(QuadInst, uv)},
+                 {2, QUAD_BINDING, vk::Format::eR8G8B8A8Unorm,
+                  offsetof(QuadInst, col)}},
+                imgui_pipeline_info, imgui_desc_set_packs,
+                info.render_pass_pack, subpass_idx);
+    }
+
+    // Create pipelines (Plots, same buffer is bound twice for lines)
+    vkw::PipelineColorBlendAttachInfo plot_pipeine_blend_info;
+    plot_pipeine_blend_info.blend_enable = true;
+    if (has_overlay) {
+        plot_pipeine_blend_info.blend_src_alpha_factor = vk::BlendFactor::eOne;
+    }
+    vkw::PipelineInfo plot_pipeline_info;
+    plot_pipeline_info.color_blend_infos = {plot_pipeine_blend_info};
+    plot_pipeline_info.depth_test_enable = false;
+    plot_pipeline_info.face_culling = vk::CullModeFlagBits::eNone;
+    pipeline_set->plot_line_pipeline_pack = vkw::CreateGraphicsPipeline(
+            device,
+            {info.plot_line_vert_shader_pack, info.plot_frag_shader_pack},
+            {{0, sizeof(float), vk::VertexInputRate::eInstance},
+             {1, sizeof(float), vk::VertexInputRate::eInstance}},
+            {{0, 0, vk::Format::eR32Sfloat, 0},
+             {1, 1, vk::Format::eR32Sfloat, 0}},
+            plot_pipeline_info, {info.imgui_desc_set_pack},
+            info.render_pass_pack, subpass_idx);
+    pipeline_set->plot_point_pipeline_pack = vkw::CreateGraphicsPipeline(
+            device,
+            {info.plot_point_vert_shader_pack, info.plot_frag_shader_pack},
+            {{0, sizeof(float), vk::VertexInputRate::eInstance}},
+            {{0, 0, vk::Format::eR32Sfloat, 0}}, plot_pipeline_info,
+            {info.imgui_desc_set_pack}, info.render_pass_pack, subpass_idx);
+
+    if (has_overlay) {
+        // Create pipeline (Composite of the overlay, premultiplied colors)
+        vkw::PipelineColorBlendAttachInfo composite_blend_info;
+        composite_blend_info.blend_enable = true;
+        composite_blend_info.blend_src_col_factor = vk::BlendFactor::eOne;
+        composite_blend_info.blend_src_alpha_factor = vk::BlendFactor::eOne;
+        vkw::PipelineInfo composite_pipeline_info;
+        composite_pipeline_info.color_blend_infos = {composite_blend_info};
+        composite_pipeline_info.depth_test_enable = false;
+        pipeline_set->composite_pipeline_pack = vkw::CreateGraphicsPipeline(
+                device, {info.bg_vert_shader_pack, info.bg_frag_shader_pack},
+                {}, {}, composite_pipeline_info, {info.bg_desc_set_pack},
+                info.dst_render_pass_pack, info.dst_has_bg ? 1 : 0);
+    }
+    return pipeline_set;
+}
+
+// BG does not depend on ImGui options and is a single tiny pipeline, so it is
+// created synchronously. (The scene is kept while others are compiling)
+const vkw::PipelinePackPtr& ObtainBgPipeline(
+        const vkw::RenderPassPackPtr& render_pass_pack) {
+    auto& bg_pipeline_pack = g_ctx.bg_pipeline_map[render_pass_pack.get()];
+    if (!bg_pipeline_pack) {
+        vkw::PipelineInfo bg_pipeline_info;
+        bg_pipeline_info.color_blend_infos.resize(1);
+        bg_pipeline_info.depth_test_enable = false;
+        bg_pipeline_pack = vkw::CreateGraphicsPipeline(
+                *g_ctx.device_p,
+                {g_ctx.bg_vert_shader_pack, g_ctx.bg_frag_shader_pack}, {}, {},
+                bg_pipeline_info, {g_ctx.bg_layout_desc_set_pack},
+                render_pass_pack, 0);
+        g_ctx.frame_stats.n_pipeline_rebuilds++;
+    }
+    return bg_pipeline_pack;
+}
+
+// Pipelines for the destination pass. With the overlay, ImGui is drawn into
+// the overlay pass, and composited into the destination pass.
+const PipelineFuture& ObtainPipelineSet(
+        const vk::Format& dst_img_format,
+        const vk::ImageLayout& dst_final_layout, bool has_bg, bool has_overlay,
+        ImGui_ImplVulkanHpp_VertexFormat vtx_format, bool is_async) {
+    const bool vtx_pulling = g_ctx.options.vertex_pulling;
+    const bool instanced_quads = g_ctx.options.instanced_quads;
+    const PipelineKey key = {dst_img_format, dst_final_layout, has_bg,
+                             has_overlay,    vtx_format,       vtx_pulling,
+                             instanced_quads};
+    auto& future = g_ctx.pipeline_cache[key];
+    if (future.valid()) {
+        return future;  // Built or being built
+    }
+
+    // Collect inputs (Shared pointers keep them alive during the build)
+    const bool is_compact =
+            (vtx_format == ImGui_ImplVulkanHpp_VertexFormat::Compact);
+    const vkw::RenderPassPackPtr& dst_render_pass_pack = ObtainRenderPass(
+            dst_img_format, vk::ImageLayout::eUndefined, dst_final_layout,
+            has_bg);
+    PipelineBuildInfo info;
+    info.device_p = g_ctx.device_p;
+    if (has_overlay) {
+        info.render_pass_pack = ObtainRenderPass(
+                dst_img_format, vk::ImageLayout::eUndefined,
+                vk::ImageLayout::eColorAttachmentOptimal, false);
+        info.has_bg = false;
+        info.dst_render_pass_pack = dst_render_pass_pack;
+        info.dst_has_bg = has_bg;
+    } else {
+        info.render_pass_pack = dst_render_pass_pack;
+        info.has_bg = has_bg;
+    }
+    info.vtx_format = vtx_format;
+    info.vtx_pulling = vtx_pulling;
+    info.instanced_quads = instanced_quads;
+    info.bg_vert_shader_pack = g_ctx.bg_vert_shader_pack;
+    info.bg_frag_shader_pack = g_ctx.bg_frag_shader_pack;
+    if (vtx_pulling) {
+        info.imgui_vert_shader_pack =
+                is_compact ? g_ctx.imgui_pull_compact_vert_shader_pack :
+                             g_ctx.imgui_pull_vert_shader_pack;
+    } else {
+        info.imgui_vert_shader_pack =
+                is_compact ? g_ctx.imgui_compact_vert_shader_pack :
+                             g_ctx.imgui_vert_shader_pack;
+    }
+    info.imgui_frag_shader_pack = g_ctx.imgui_frag_shader_pack;
+    info.quad_vert_shader_pack = g_ctx.imgui_quad_vert_shader_pack;
+    info.plot_line_vert_shader_pack = g_ctx.plot_line_vert_shader_pack;
+    info.plot_point_vert_shader_pack = g_ctx.plot_point_vert_shader_pack;
+    info.plot_frag_shader_pack = g_ctx.plot_frag_shader_pack;
+    info.bg_desc_set_pack = g_ctx.bg_layout_desc_set_pack;
+    info.imgui_desc_set_pack = g_ctx.imgui_desc_set_pack;
+    info.tex_desc_set_pack = g_ctx.tex_layout_desc_set_pack;
+
+    if (is_async) {
+        future = std::async(std::launch::async, BuildPipelineSet, info).share();
+    } else {
+        std::promise<PipelineSetPtr> promise;
+        promise.set_value(BuildPipelineSet(info));
+        future = promise.get_future().share();
+    }
+    // ImGui, plot lines/points, quads and composite
+    g_ctx.frame_stats.n_pipeline_rebuilds +=
+            3u + (instanced_quads ? 1u : 0u) + (has_overlay ? 1u : 0u);
+    return future;
+}
+
+bool IsReady(const PipelineFuture& future) {
+    return future.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+}
+
+vk::FormatFeatureFlags ObtainFormatFeatures(const vk::Format& format) {
+    auto it = g_ctx.format_features.find(format);
+    if (it == g_ctx.format_features.end()) {
+        auto&& physical_device = *g_ctx.physical_device_p;
+        const auto& props = physical_device.getFormatProperties(format);
+        it = g_ctx.format_features
+                     .emplace(format, props.optimalTilingFeatures)
+                     .first;
+    }
+    return it->second;
+}
+
+// Cheapest composition allowed by the images and the option
+ImGui_ImplVulkanHpp_BgComposite SelectBgComposite(
+        const vk::Format& dst_img_format, const vk::Extent2D& dst_img_size) {
+    using BgComposite = ImGui_ImplVulkanHpp_BgComposite;
+    const auto& bg_imgs = g_ctx.bg_imgs;
+    const BgComposite pref = g_ctx.options.bg_composite;
+    if (!bg_imgs.bg_img || !bg_imgs.dst_img || pref == BgComposite::Shader) {
+        return BgComposite::Shader;
+    }
+    const bool can_copy = bg_imgs.bg_img_format == dst_img_format &&
+                          bg_imgs.bg_img_size == dst_img_size;
+    const bool can_blit =
+            (ObtainFormatFeatures(bg_imgs.bg_img_format) &
+             vk::FormatFeatureFlagBits::eBlitSrc) &&
+            (ObtainFormatFeatures(dst_img_format) &
+             vk::FormatFeatureFlagBits::eBlitDst);
+    if (can_copy && (pref == BgComposite::Auto || pref == BgComposite::Copy)) {
+        return BgComposite::Copy;
+    }
+    if (can_blit && (pref == BgComposite::Auto || pref == BgComposite::Blit)) {
+        return BgComposite::Blit;
+    }
+    return BgComposite::Shader;
+}
+
+// Recreates the overlay target when its size or format changes
+void UpdateOverlayTarget(const vk::Format& dst_img_format,
+                         const vk::Extent2D& dst_img_size) {
+    auto&& device = *g_ctx.device_p;
+    auto& stats = g_ctx.frame_stats;
+    auto& target = g_ctx.overlay_target;
+    const float scale = g_ctx.options.overlay_scale;
+    if (!(0.f < scale && scale < 1.f)) {
+        Retire(std::move(target));  // Full resolution
+        return;
+    }
+    auto scale_len = [&](uint32_t len) {
+        const float scaled = std::ceil(static_cast<float>(len) * scale);
+        return std::max(1u, static_cast<uint32_t>(scaled));
+    };
+    const vk::Extent2D size = {scale_len(dst_img_size.width),
+                               scale_len(dst_img_size.height)};
+    if (target && target->img->size == size &&
+        target->format == dst_img_format) {
+        return;  // Reuse
+    }
+
+    // Retired, because previous frames may still sample it
+    Retire(std::move(target));
+    target = std::make_shared<OverlayTarget>();
+    target->format = dst_img_format;
+    target->img = CreatePooledImage(dst_img_format, size,
+                                    vk::ImageUsageFlagBits::eColorAttachment |
+                                            vk::ImageUsageFlagBits::eSampled);
+    target->render_pass_pack = CreateRenderPass(
+            dst_img_format, vk::ImageLayout::eColorAttachmentOptimal,
+            vk::ImageLayout::eColorAttachmentOptimal, false,
+            vk::AttachmentLoadOp::eClear);
+    target->frame_buf = vkw::CreateFrameBuffer(
+            device, target->render_pass_pack, {target->img->view.get()}, size);
+    // Same bilinear filtering as BG
+    target->desc_set = AllocDescSet(g_ctx.bg_desc_pools);
+    WriteImageDescSet(target->desc_set->desc_set, g_ctx.bg_sampler.get(),
+                      target->img->view.get(),
+                      vk::ImageLayout::eShaderReadOnlyOptimal);
+    stats.n_render_pass_rebuilds++;
+    stats.n_frame_buf_rebuilds++;
+}
+
+// Frame buffers of a destroyed view must not be found by a recycled handle
+// (Called between frames, so the last recorded frame may use them)
+void RetireFrameBufs(const vk::ImageView& img_view) {
+    auto& frame_buf_map = g_ctx.frame_buf_map;
+    for (auto it = frame_buf_map.begin(); it != frame_buf_map.end();) {
+        if (std::get<0>(it->first) == static_cast<VkImageView>(img_view)) {
+            Retire(std::move(it->second.frame_buf), g_ctx.frame_idx);
+            it = frame_buf_map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Transient targets do not accumulate frame buffers
+void RetireIdleFrameBufs() {
+    auto& frame_buf_map = g_ctx.frame_buf_map;
+    for (auto it = frame_buf_map.begin(); it != frame_buf_map.end();) {
+        const uint64_t last_frame_idx = it->second.last_frame_idx;
+        if (last_frame_idx + N_FRAME_BUF_IDLE_FRAMES < g_ctx.frame_idx) {
+            Retire(std::move(it->second.frame_buf), last_frame_idx);
+            it = frame_buf_map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Drops every cached pass, pipeline and frame buffer at once (For a device
+// change. Pending builds are waited by the destruction of their futures)
+void ClearRenderPipelineCaches() {
+    g_ctx.frame_buf_map.clear();
+    g_ctx.render_pass_pack.reset();
+    g_ctx.imgui_render_pass_pack.reset();
+    g_ctx.bg_pipeline_pack.reset();
+    g_ctx.imgui_pipeline_pack.reset();
+    g_ctx.quad_pipeline_pack.reset();
+    g_ctx.plot_line_pipeline_pack.reset();
+    g_ctx.plot_point_pipeline_pack.reset();
+    g_ctx.composite_pipeline_pack.reset();
+    g_ctx.bg_pipeline_map.clear();
+    g_ctx.pipeline_cache.clear();
+    g_ctx.render_pass_cache.clear();
+    g_ctx.bg_desc_set.reset();
+    g_ctx.format_features.clear();  // Of the physical device
+    g_ctx.gpu_timing = {};
+}
+
+vkw::FrameBufferPackPtr UpdateRenderPipeline(
+        const vk::Format& dst_img_format, const vk::ImageView& dst_img_view,
+        const vk::Extent2D& dst_img_size,
+        const vk::ImageLayout& dst_final_layout,
+        const vk::ImageView& bg_img_view,
+        const vk::ImageLayout& bg_img_layout) {
+    auto&& device = *g_ctx.device_p;
+    auto& stats = g_ctx.frame_stats;
+
+    // BG by transfer is loaded into the render pass, instead of a subpass
+    using BgComposite = ImGui_ImplVulkanHpp_BgComposite;
+    g_ctx.bg_composite =
+            bg_img_view ? SelectBgComposite(dst_img_format, dst_img_size) :
+                          BgComposite::Shader;
+    const bool is_bg_transferred =
+            bg_img_view && g_ctx.bg_composite != BgComposite::Shader;
+    const bool has_bg = bg_img_view && !is_bg_transferred;
+    const vk::ImageLayout dst_init_layout =
+            is_bg_transferred ? vk::ImageLayout::eColorAttachmentOptimal :
+                                vk::ImageLayout::eUndefined;
+    g_ctx.has_bg_pass = has_bg;
+
+    if (g_ctx.bg_img_view != bg_img_view ||
+        g_ctx.bg_img_layout != bg_img_layout) {
+        g_ctx.bg_img_view = bg_img_view;
+        g_ctx.bg_img_layout = bg_img_layout;
+
+        // Descriptor set in use must not be updated -> Always new one
+        // (Retired sets return to the free list and are reused later)
+        Retire(std::move(g_ctx.bg_desc_set));
+        if (bg_img_view) {
+            g_ctx.bg_desc_set = AllocDescSet(g_ctx.bg_desc_pools);
+            WriteImageDescSet(g_ctx.bg_desc_set->desc_set,
+                              g_ctx.bg_sampler.get(), bg_img_view,
+                              bg_img_layout);
+        }
+    }
+
+    // Render pass and pipelines (Cached for each target)
+    g_ctx.render_pass_pack = ObtainRenderPass(dst_img_format, dst_init_layout,
+                                              dst_final_layout, has_bg);
+    // ImGui is drawn into the overlay target when it is reduced
+    UpdateOverlayTarget(dst_img_format, dst_img_size);
+    const bool has_overlay = static_cast<bool>(g_ctx.overlay_target);
+    const vk::ImageLayout imgui_final_layout =
+            has_overlay ? vk::ImageLayout::eColorAttachmentOptimal :
+                          dst_final_layout;
+    const bool imgui_has_bg = has_bg && !has_overlay;
+    // Compatible pass from the cache (Pipelines and user callbacks)
+    g_ctx.imgui_render_pass_pack =
+            has_overlay ? ObtainRenderPass(dst_img_format,
+                                           vk::ImageLayout::eUndefined,
+                                           imgui_final_layout, false) :
+                          g_ctx.render_pass_pack;
+    g_ctx.imgui_subpass_idx = imgui_has_bg ? 1 : 0;
+    g_ctx.bg_pipeline_pack =
+            has_bg ? ObtainBgPipeline(g_ctx.render_pass_pack) : nullptr;
+    const PipelineFuture& pipeline_set = ObtainPipelineSet(
+            dst_img_format, dst_final_layout, has_bg, has_overlay,
+            g_ctx.vtx_format, g_ctx.options.async_pipeline_build);
+    if (IsReady(pipeline_set)) {
+        const PipelineSet& set = *pipeline_set.get();
+        g_ctx.imgui_pipeline_pack = set.imgui_pipeline_pack;
+        g_ctx.quad_pipeline_pack = set.quad_pipeline_pack;
+        g_ctx.composite_pipeline_pack = set.composite_pipeline_pack;
+        g_ctx.plot_line_pipeline_pack = set.plot_line_pipeline_pack;
+        g_ctx.plot_point_pipeline_pack = set.plot_point_pipeline_pack;
+    } else {
+        // Still compiling -> Skip the overlay in this frame (BG is drawn)
+        g_ctx.imgui_pipeline_pack = nullptr;
+        g_ctx.quad_pipeline_pack = nullptr;
+        g_ctx.composite_pipeline_pack = nullptr;
+        g_ctx.plot_line_pipeline_pack = nullptr;
+        g_ctx.plot_point_pipeline_pack = nullptr;
+        stats.n_skipped_overlays++;
+    }
+    g_ctx.vtx_pulling = g_ctx.options.vertex_pulling;
+
+    // Create frame buffer
+    const Context::FrameBufKey key = {static_cast<VkImageView>(dst_img_view),
+                                      dst_img_size.width, dst_img_size.height,
+                                      g_ctx.render_pass_pack.get()};
+    RetireIdleFrameBufs();
+    auto& cached = g_ctx.frame_buf_map[key];
+    if (!cached.frame_buf) {
+        // Create & Register
+        cached.frame_buf = CreateFrameBuffer(device, g_ctx.render_pass_pack,
+                                             {dst_img_view}, dst_img_size);
+        stats.n_frame_buf_rebuilds++;
+    }
+    cached.last_frame_idx = g_ctx.frame_idx;
+    return cached.frame_buf;
+}
+
+void UpdateUnifBuf(ImDrawData* draw_data) {
+    // Send to uniform buffer (Region in the arena)
+    UnifBuf unif_buf;
+    unif_buf.scale[0] = 2.f / draw_data->DisplaySize.x;
+    unif_buf.scale[1] = 2.f / draw_data->DisplaySize.y;
+    unif_buf.shift[0] = -1.f - draw_data->DisplayPos.x * unif_buf.scale[0];
+    unif_buf.shift[1] = -1.f - draw_data->DisplayPos.y * unif_buf.scale[1];
+    unif_buf.origin[0] = draw_data->DisplayPos.x;
+    unif_buf.origin[1] = draw_data->DisplayPos.y;
+    auto& arena = GetCurrArena();
+    memcpy(arena.mapped_p + arena.unif_offset, &unif_buf, sizeof(UnifBuf));
+    g_ctx.frame_stats.uploaded_bytes += sizeof(UnifBuf);
+}
+
+// Draw callback of `ImGui_ImplVulkanHpp_AddPlot`
+void DrawPlot(const ImDrawList* cmd_list, const ImDrawCmd* pcmd) {
+    (void)cmd_list;
+    const size_t plot_idx = reinterpret_cast<size_t>(pcmd->UserCallbackData);
+    const auto& desc = g_ctx.plot_descs[plot_idx];
+    const auto& state = g_ctx.render_state;
+    const bool is_line = (desc.type == ImGui_ImplVulkanHpp_PlotType::Lines);
+    const uint32_t n_instances = is_line ? desc.n_samples - 1 : desc.n_samples;
+    if (desc.n_samples < (is_line ? 2u : 1u) ||
+        state.scissor.extent.width == 0 || state.scissor.extent.height == 0) {
+        return;  // Nothing visible
+    }
+    auto& stats = g_ctx.frame_stats;
+
+    const auto& pipeline_pack = is_line ? g_ctx.plot_line_pipeline_pack :
+                                          g_ctx.plot_point_pipeline_pack;
+    const auto& arena = GetCurrArena();
+    const std::array<uint32_t, 3> dyn_offsets = {
+            static_cast<uint32_t>(arena.unif_offset),
+            static_cast<uint32_t>(arena.vtx_offset),
+            static_cast<uint32_t>(g_ctx.plot_offsets[plot_idx])};
+    const vk::CommandBuffer cmd_buf = state.cmd_buf;
+    cmd_buf.setScissor(0, state.scissor);
+    cmd_buf.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                         pipeline_pack->pipeline.get());
+    cmd_buf.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                               pipeline_pack->pipeline_layout.get(), 0,
+                               arena.desc_set->desc_set, dyn_offsets);
+    if (is_line) {
+        const std::array<vk::Buffer, 2> bufs = {desc.samples_buf,
+                                                desc.samples_buf};
+        const std::array<vk::DeviceSize, 2> offsets = {
+                desc.samples_offset, desc.samples_offset + sizeof(float)};
+        cmd_buf.bindVertexBuffers(0, bufs, offsets);
+    } else {
+        cmd_buf.bindVertexBuffers(0, desc.samples_buf, desc.samples_offset);
+    }
+    cmd_buf.draw(6, n_instances, 0, 0);
+    stats.n_scissor_calls++;
+    stats.n_bind_calls += 3;
+    stats.n_draw_calls++;
+}
+
+// Commands are recorded into `vk::CommandBuffer` directly with values on the
+// stack. (vkw helpers take containers, which allocate in every frame)
+void CmdSetFullViewport(const vk::CommandBuffer& cmd_buf,
+                        const vk::Extent2D& size) {
+    const vk::Viewport viewport(0.f, 0.f, static_cast<float>(size.width),
+                                static_cast<float>(size.height), 0.f, 1.f);
+    cmd_buf.setViewport(0, viewport);
+}
+
+void CmdSetFullScissor(const vk::CommandBuffer& cmd_buf,
+                       const vk::Extent2D& size) {
+    cmd_buf.setScissor(0, vk::Rect2D({0, 0}, size));
+}
+
+void CmdBeginPass(const vk::CommandBuffer& cmd_buf,
+                  const vkw::RenderPassPackPtr& render_pass_pack,
+                  const vkw::FrameBufferPackPtr& frame_buf,
+                  const vk::ClearValue* clear_val /* nullable */) {
+    const vk::RenderPassBeginInfo begin_info(
+            render_pass_pack->render_pass.get(), frame_buf->frame_buffer.get(),
+            vk::Rect2D({0, 0}, {frame_buf->width, frame_buf->height}),
+            clear_val ? 1u : 0u, clear_val);
+    cmd_buf.beginRenderPass(begin_info, vk::SubpassContents::eInline);
+}
+
+// Fullscreen triangle of BG or composite with its single descriptor set
+void CmdDrawFullscreen(const vk::CommandBuffer& cmd_buf,
+                       const vkw::PipelinePackPtr& pipeline_pack,
+                       const vk::DescriptorSet& desc_set,
+                       const vk::Extent2D& size) {
+    auto& stats = g_ctx.frame_stats;
+    CmdSetFullScissor(cmd_buf, size);
+    cmd_buf.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                         pipeline_pack->pipeline.get());
+    cmd_buf.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                               pipeline_pack->pipeline_layout.get(), 0,
+                               desc_set, nullptr);
+    cmd_buf.draw(3, 1, 0, 0);
+    stats.n_scissor_calls++;
+    stats.n_bind_calls += 2;
+    stats.n_draw_calls++;
+}
+
+void BeginOnceCommand(const vk::UniqueCommandBuffer& dst_cmd_buf) {
+    dst_cmd_buf->reset(vk::CommandBufferResetFlags());
+    dst_cmd_buf->begin(vk::CommandBufferBeginInfo(
+            vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+}
+
+// Binds pipeline, descriptor set, buffers and viewport for ImGui draws
+// (Also called for `ImDrawCallback_ResetRenderState`)
+void SetupRenderState(const vk::UniqueCommandBuffer& dst_cmd_buf,
+                      const vkw::FrameBufferPackPtr& frame_buf) {
+    auto& stats = g_ctx.frame_stats;
+    const auto& arena = GetCurrArena();
+    const vk::CommandBuffer cmd_buf = dst_cmd_buf.get();
+    const vk::Buffer arena_buf = arena.buf->buf.get();
+
+    CmdSetFullViewport(cmd_buf, {frame_buf->width, frame_buf->height});
+    cmd_buf.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                         g_ctx.imgui_pipeline_pack->pipeline.get());
+    const std::array<uint32_t, 3> dyn_offsets = {
+            static_cast<uint32_t>(arena.unif_offset),
+            static_cast<uint32_t>(arena.vtx_offset),
+            0u};  // Plot parameters (Unused)
+    cmd_buf.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                               g_ctx.imgui_pipeline_pack->pipeline_layout.get(),
+                               0, arena.desc_set->desc_set, dyn_offsets);
+    if (!g_ctx.vtx_pulling) {
+        cmd_buf.bindVertexBuffers(0, arena_buf, arena.vtx_offset);
+        stats.n_bind_calls++;
+    }
+    cmd_buf.bindIndexBuffer(arena_buf, arena.idx_offset, IDX_TYPE);
+    stats.n_bind_calls += 3;
+    if (g_ctx.instanced_quads) {
+        // Separate binding, kept while switching pipelines
+        cmd_buf.bindVertexBuffers(QUAD_BINDING, arena_buf, arena.quad_offset);
+        stats.n_bind_calls++;
+    }
+}
 
-    // Send vertex/index data to GPU (TODO: Async)
-    uint8_t* vtx_dst = MapDeviceMem(device, g_ctx.vtx_buf_pack, vtx_size);
-    uint8_t* idx_dst = MapDeviceMem(device, g_ctx.idx_buf_pack, idx_size);
-    for (int n = 0; n < draw_data->CmdListsCount; n++) {
-        const ImDrawList* cmd_list = draw_data->CmdLists[n];
-        const size_t vtx_n_bytes =
-                static_cast<size_t>(cmd_list->VtxBuffer.Size) *
-                sizeof(ImDrawVert);
-        const size_t idx_n_bytes =
-                static_cast<size_t>(cmd_list->IdxBuffer.Size) *
-                sizeof(ImDrawIdx);
-        memcpy(vtx_dst, cmd_list->VtxBuffer.Data, vtx_n_bytes);
-        memcpy(idx_dst, cmd_list->IdxBuffer.Data, idx_n_bytes);
-        vtx_dst += vtx_n_bytes;
-        idx_dst += idx_n_bytes;
+// Converts `ClipRect` into framebuffer space (False if fully clipped)
+bool ObtainScissor(const ImDrawCmd* pcmd, const ImVec2& clip_off,
+                   const ImVec2& clip_scale, const ImVec2& draw_size,
+                   vk::Rect2D& scissor) {
+    ImVec4 clip_rect = {(pcmd->ClipRect.x - clip_off.x) * clip_scale.x,
+                        (pcmd->ClipRect.y - clip_off.y) * clip_scale.y,
+                        (pcmd->ClipRect.z - clip_off.x) * clip_scale.x,
+                        (pcmd->ClipRect.w - clip_off.y) * clip_scale.y};
+    if (!(clip_rect.x < draw_size.x && clip_rect.y < draw_size.y &&
+          0 <= clip_rect.z && 0 <= clip_rect.w)) {
+        scissor = vk::Rect2D{};
+        return false;
     }
-    UnmapDeviceMem(device, g_ctx.vtx_buf_pack);
-    UnmapDeviceMem(device, g_ctx.idx_buf_pack);
 
+    // Negative offsets are illegal for vkCmdSetScissor
+    clip_rect.x = std::max(clip_rect.x, 0.f);
+    clip_rect.y = std::max(clip_rect.y, 0.f);
+    scissor = vk::Rect2D{{static_cast<int32_t>(clip_rect.x),
+                          static_cast<int32_t>(clip_rect.y)},
+                         {static_cast<uint32_t>(clip_rect.z - clip_rect.x),
+                          static_cast<uint32_t>(clip_rect.w - clip_rect.y)}};
     return true;
 }
 
-void UpdateFontTex(const vk::UniqueCommandBuffer& dst_cmd_buf) {
-    if (g_ctx.is_font_tex_sent) {
-        // Release transferring resources
-        g_ctx.font_buf_pack = nullptr;
+// Copies or blits BG into the destination, which is left for color output.
+// BG is returned to the layout given by the caller.
+void CmdTransferBg(const vk::UniqueCommandBuffer& dst_cmd_buf,
+                   const vk::Extent2D& dst_img_size) {
+    const auto& bg_imgs = g_ctx.bg_imgs;
+    const vk::ImageSubresourceRange subres_range = {
+            vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+    const vk::ImageSubresourceLayers subres_layers = {
+            vk::ImageAspectFlagBits::eColor, 0, 0, 1};
+    const std::array<vk::ImageMemoryBarrier, 2> to_transfer = {{
+            {vk::AccessFlagBits::eMemoryWrite,
+             vk::AccessFlagBits::eTransferRead, g_ctx.bg_img_layout,
+             vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED,
+             VK_QUEUE_FAMILY_IGNORED, bg_imgs.bg_img, subres_range},
+            {{},  // Previous contents are discarded
+             vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined,
+             vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED,
+             VK_QUEUE_FAMILY_IGNORED, bg_imgs.dst_img, subres_range},
+    }};
+    dst_cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands,
+                                 vk::PipelineStageFlagBits::eTransfer, {},
+                                 nullptr, nullptr, to_transfer);
 
-        return;  // Already created
+    if (g_ctx.bg_composite == ImGui_ImplVulkanHpp_BgComposite::Copy) {
+        const vk::ImageCopy region = {
+                subres_layers,
+                {0, 0, 0},
+                subres_layers,
+                {0, 0, 0},
+                {dst_img_size.width, dst_img_size.height, 1}};
+        dst_cmd_buf->copyImage(bg_imgs.bg_img,
+                               vk::ImageLayout::eTransferSrcOptimal,
+                               bg_imgs.dst_img,
+                               vk::ImageLayout::eTransferDstOptimal, region);
+    } else {
+        // Stretched as the shader composition
+        vk::ImageBlit region;
+        region.srcSubresource = subres_layers;
+        region.srcOffsets[1] = vk::Offset3D{
+                static_cast<int32_t>(bg_imgs.bg_img_size.width),
+                static_cast<int32_t>(bg_imgs.bg_img_size.height), 1};
+        region.dstSubresource = subres_layers;
+        region.dstOffsets[1] =
+                vk::Offset3D{static_cast<int32_t>(dst_img_size.width),
+                             static_cast<int32_t>(dst_img_size.height), 1};
+        const bool is_linear =
+                static_cast<bool>(ObtainFormatFeatures(bg_imgs.bg_img_format) &
+                                  vk::FormatFeatureFlagBits::
+                                          eSampledImageFilterLinear);
+        dst_cmd_buf->blitImage(
+                bg_imgs.bg_img, vk::ImageLayout::eTransferSrcOptimal,
+                bg_imgs.dst_img, vk::ImageLayout::eTransferDstOptimal, region,
+                is_linear ? vk::Filter::eLinear : vk::Filter::eNearest);
     }
-    g_ctx.is_font_tex_sent = true;
 
-    auto&& physical_device = *g_ctx.physical_device_p;
-    auto&& device = *g_ctx.device_p;
+    const vk::ImageMemoryBarrier bg_to_caller = {
+            vk::AccessFlagBits::eTransferRead,
+            vk::AccessFlagBits::eMemoryRead,
+            vk::ImageLayout::eTransferSrcOptimal,
+            g_ctx.bg_img_layout,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            bg_imgs.bg_img,
+            subres_range};
+    dst_cmd_buf->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                 vk::PipelineStageFlagBits::eAllCommands, {},
+                                 nullptr, nullptr, bg_to_caller);
+    // Initial layout of the render pass
+    const vk::ImageMemoryBarrier dst_to_color = {
+            vk::AccessFlagBits::eTransferWrite,
+            vk::AccessFlagBits::eColorAttachmentRead |
+                    vk::AccessFlagBits::eColorAttachmentWrite,
+            vk::ImageLayout::eTransferDstOptimal,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            bg_imgs.dst_img,
+            subres_range};
+    dst_cmd_buf->pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, nullptr,
+            nullptr, dst_to_color);
+    g_ctx.frame_stats.n_bg_transfers++;
+}
 
-    // Create transferring buffer
-    g_ctx.font_buf_pack = vkw::CreateBufferPack(
-            physical_device, device, g_ctx.font_pixel_size,
-            vk::BufferUsageFlagBits::eTransferSrc, vkw::HOST_VISIB_COHER_PROPS);
+// Splits draw lists into commands to be culled (Same form as packed ones)
+void GatherListCmds(const ImDrawData* draw_data) {
+    auto& list_cmds = g_ctx.clip_culling.list_cmds;
+    list_cmds.clear();
+    uint32_t global_vtx_offset = 0;
+    uint32_t global_idx_offset = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; n++) {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++) {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            PackedCmd cmd;
+            cmd.cmd_list = cmd_list;
+            cmd.pcmd = pcmd;
+            cmd.first = pcmd->IdxOffset + global_idx_offset;
+            cmd.count = pcmd->ElemCount;
+            cmd.vtx_offset =
+                    static_cast<int32_t>(pcmd->VtxOffset + global_vtx_offset);
+            list_cmds.push_back(cmd);
+        }
+        global_idx_offset += static_cast<uint32_t>(cmd_list->IdxBuffer.Size);
+        global_vtx_offset += static_cast<uint32_t>(cmd_list->VtxBuffer.Size);
+    }
+}
 
-    // Send from CPU to buffer (TODO: Async)
-    SendToDevice(device, g_ctx.font_buf_pack, g_ctx.font_pixel_p,
-                 g_ctx.font_pixel_size);
+// Same results as `ObtainScissor` for 4 rects at a time
+void TransformClipRects(ClipCulling& culling, const ImVec2& clip_off,
+                        const ImVec2& clip_scale, const ImVec2& draw_size) {
+    const size_t n_rects = AlignUp(culling.x0s.size(), 4);
+    culling.x0s.resize(n_rects);  // Padded with empty rects
+    culling.y0s.resize(n_rects);
+    culling.x1s.resize(n_rects);
+    culling.y1s.resize(n_rects);
+    culling.offset_xs.resize(n_rects);
+    culling.offset_ys.resize(n_rects);
+    culling.extent_ws.resize(n_rects);
+    culling.extent_hs.resize(n_rects);
+    culling.visible_masks.resize(n_rects);
 
-    // Copy from buffer to image
-    vkw::CopyBufferToImage(dst_cmd_buf, g_ctx.font_buf_pack,
-                           g_ctx.font_img_pack, vk::ImageLayout::eUndefined,
-                           vk::ImageLayout::eShaderReadOnlyOptimal);
+#if defined(IMGUI_IMPL_VULKANHPP_SSE2)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 off_x = _mm_set1_ps(clip_off.x);
+    const __m128 off_y = _mm_set1_ps(clip_off.y);
+    const __m128 scale_x = _mm_set1_ps(clip_scale.x);
+    const __m128 scale_y = _mm_set1_ps(clip_scale.y);
+    const __m128 size_x = _mm_set1_ps(draw_size.x);
+    const __m128 size_y = _mm_set1_ps(draw_size.y);
+    for (size_t i = 0; i < n_rects; i += 4) {
+        const __m128 x0 = _mm_mul_ps(
+                _mm_sub_ps(_mm_loadu_ps(&culling.x0s[i]), off_x), scale_x);
+        const __m128 y0 = _mm_mul_ps(
+                _mm_sub_ps(_mm_loadu_ps(&culling.y0s[i]), off_y), scale_y);
+        const __m128 x1 = _mm_mul_ps(
+                _mm_sub_ps(_mm_loadu_ps(&culling.x1s[i]), off_x), scale_x);
+        const __m128 y1 = _mm_mul_ps(
+                _mm_sub_ps(_mm_loadu_ps(&culling.y1s[i]), off_y), scale_y);
+        const __m128 visible = _mm_and_ps(
+                _mm_and_ps(_mm_cmplt_ps(x0, size_x), _mm_cmplt_ps(y0, size_y)),
+                _mm_and_ps(_mm_cmple_ps(zero, x1), _mm_cmple_ps(zero, y1)));
+        // Negative offsets are illegal for vkCmdSetScissor
+        const __m128 clamped_x0 = _mm_max_ps(x0, zero);
+        const __m128 clamped_y0 = _mm_max_ps(y0, zero);
+        auto store = [](std::vector<int32_t>& dst, size_t idx, __m128i v) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[idx]), v);
+        };
+        store(culling.offset_xs, i, _mm_cvttps_epi32(clamped_x0));
+        store(culling.offset_ys, i, _mm_cvttps_epi32(clamped_y0));
+        store(culling.extent_ws, i,
+              _mm_cvttps_epi32(_mm_sub_ps(x1, clamped_x0)));
+        store(culling.extent_hs, i,
+              _mm_cvttps_epi32(_mm_sub_ps(y1, clamped_y0)));
+        _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(&culling.visible_masks[i]),
+                _mm_castps_si128(visible));
+    }
+#elif defined(IMGUI_IMPL_VULKANHPP_NEON)
+    const float32x4_t zero = vdupq_n_f32(0.f);
+    const float32x4_t off_x = vdupq_n_f32(clip_off.x);
+    const float32x4_t off_y = vdupq_n_f32(clip_off.y);
+    const float32x4_t scale_x = vdupq_n_f32(clip_scale.x);
+    const float32x4_t scale_y = vdupq_n_f32(clip_scale.y);
+    const float32x4_t size_x = vdupq_n_f32(draw_size.x);
+    const float32x4_t size_y = vdupq_n_f32(draw_size.y);
+    for (size_t i = 0; i < n_rects; i += 4) {
+        const float32x4_t x0 = vmulq_f32(
+                vsubq_f32(vld1q_f32(&culling.x0s[i]), off_x), scale_x);
+        const float32x4_t y0 = vmulq_f32(
+                vsubq_f32(vld1q_f32(&culling.y0s[i]), off_y), scale_y);
+        const float32x4_t x1 = vmulq_f32(
+                vsubq_f32(vld1q_f32(&culling.x1s[i]), off_x), scale_x);
+        const float32x4_t y1 = vmulq_f32(
+                vsubq_f32(vld1q_f32(&culling.y1s[i]), off_y), scale_y);
+        const uint32x4_t visible = vandq_u32(
+                vandq_u32(vcltq_f32(x0, size_x), vcltq_f32(y0, size_y)),
+                vandq_u32(vcleq_f32(zero, x1), vcleq_f32(zero, y1)));
+        // Negative offsets are illegal for vkCmdSetScissor
+        const float32x4_t clamped_x0 = vmaxq_f32(x0, zero);
+        const float32x4_t clamped_y0 = vmaxq_f32(y0, zero);
+        vst1q_s32(&culling.offset_xs[i], vcvtq_s32_f32(clamped_x0));
+        vst1q_s32(&culling.offset_ys[i], vcvtq_s32_f32(clamped_y0));
+        vst1q_s32(&culling.extent_ws[i],
+                  vcvtq_s32_f32(vsubq_f32(x1, clamped_x0)));
+        vst1q_s32(&culling.extent_hs[i],
+                  vcvtq_s32_f32(vsubq_f32(y1, clamped_y0)));
+        vst1q_u32(&culling.visible_masks[i], visible);
+    }
+#else
+    for (size_t i = 0; i < n_rects; i++) {
+        const float x0 = (culling.x0s[i] - clip_off.x) * clip_scale.x;
+        const float y0 = (culling.y0s[i] - clip_off.y) * clip_scale.y;
+        const float x1 = (culling.x1s[i] - clip_off.x) * clip_scale.x;
+        const float y1 = (culling.y1s[i] - clip_off.y) * clip_scale.y;
+        const bool visible =
+                x0 < draw_size.x && y0 < draw_size.y && 0 <= x1 && 0 <= y1;
+        // Negative offsets are illegal for vkCmdSetScissor
+        const float clamped_x0 = std::max(x0, 0.f);
+        const float clamped_y0 = std::max(y0, 0.f);
+        culling.offset_xs[i] = static_cast<int32_t>(clamped_x0);
+        culling.offset_ys[i] = static_cast<int32_t>(clamped_y0);
+        culling.extent_ws[i] = static_cast<int32_t>(x1 - clamped_x0);
+        culling.extent_hs[i] = static_cast<int32_t>(y1 - clamped_y0);
+        culling.visible_masks[i] = visible ? UINT32_MAX : 0u;
+    }
+#endif
 }
 
-vkw::FrameBufferPackPtr UpdateRenderPipeline(
-        const vk::Format& dst_img_format, const vk::ImageView& dst_img_view,
-        const vk::Extent2D& dst_img_size,
-        const vk::ImageLayout& dst_final_layout,
-        const vk::ImageView& bg_img_view,
-        const vk::ImageLayout& bg_img_layout) {
-    auto&& device = *g_ctx.device_p;
+// Pre-pass which leaves only visible draws (and callbacks) with scissors
+void CullDrawCmds(const std::vector<PackedCmd>& cmds, const ImVec2& clip_off,
+                  const ImVec2& clip_scale, const ImVec2& draw_size) {
+    auto& culling = g_ctx.clip_culling;
+    constexpr uint32_t NO_RECT = UINT32_MAX;  // User callbacks
 
-    const bool needs_update = g_ctx.dst_img_format != dst_img_format ||
-                              g_ctx.dst_final_layout != dst_final_layout ||
-                              g_ctx.bg_img_view != bg_img_view ||
-                              g_ctx.bg_img_layout != bg_img_layout;
-    if (needs_update) {
-        g_ctx.dst_img_format = dst_img_format;
-        g_ctx.dst_final_layout = dst_final_layout;
-        g_ctx.bg_img_view = bg_img_view;
-        g_ctx.bg_img_layout = bg_img_layout;
+    // Gather clip rects (Runs of the same command share one)
+    culling.x0s.clear();
+    culling.y0s.clear();
+    culling.x1s.clear();
+    culling.y1s.clear();
+    culling.rect_idxs.resize(cmds.size());
+    const ImDrawCmd* prev_pcmd = nullptr;
+    for (size_t i = 0; i < cmds.size(); i++) {
+        const ImDrawCmd* pcmd = cmds[i].pcmd;
+        if (pcmd->UserCallback != nullptr) {
+            culling.rect_idxs[i] = NO_RECT;
+            prev_pcmd = nullptr;
+            continue;
+        }
+        if (pcmd != prev_pcmd) {
+            prev_pcmd = pcmd;
+            culling.x0s.push_back(pcmd->ClipRect.x);
+            culling.y0s.push_back(pcmd->ClipRect.y);
+            culling.x1s.push_back(pcmd->ClipRect.z);
+            culling.y1s.push_back(pcmd->ClipRect.w);
+        }
+        culling.rect_idxs[i] = static_cast<uint32_t>(culling.x0s.size() - 1);
+    }
 
-        if (bg_img_view) {
-            // Bind descriptor set with actual buffer (BG)
-            g_ctx.bg_write_desc_set_pack = vkw::CreateWriteDescSetPack();
-            std::vector<vk::DescriptorImageInfo> desc_img_infos = {
-                    {g_ctx.bg_sampler.get(), bg_img_view, bg_img_layout}};
-            vkw::AddWriteDescSet(g_ctx.bg_write_desc_set_pack,
-                                 g_ctx.bg_desc_set_pack, 0, desc_img_infos);
-            vkw::UpdateDescriptorSets(device, g_ctx.bg_write_desc_set_pack);
-        }
-
-        // Create render pass
-        g_ctx.render_pass_pack = vkw::CreateRenderPassPack();
-        // Add color attachment
-        vkw::AddAttachientDesc(g_ctx.render_pass_pack, dst_img_format,
-                               vk::ImageLayout::eUndefined, dst_final_layout,
-                               vk::AttachmentLoadOp::eLoad,
-                               vk::AttachmentStoreOp::eStore);
-        // Add subpass
-        if (bg_img_view) {
-            vkw::AddSubpassDesc(
-                    g_ctx.render_pass_pack, {},
-                    {{0, vk::ImageLayout::eColorAttachmentOptimal}});
-            vkw::AddSubpassDepend(
-                    g_ctx.render_pass_pack,
-                    {0, vk::PipelineStageFlagBits::eColorAttachmentOutput,
-                     vk::AccessFlagBits::eColorAttachmentWrite},
-                    {1, vk::PipelineStageFlagBits::eColorAttachmentOutput,
-                     vk::AccessFlagBits::eColorAttachmentRead},
-                    vk::DependencyFlagBits::eByRegion);
-        }
-        vkw::AddSubpassDesc(g_ctx.render_pass_pack, {},
-                            {{0, vk::ImageLayout::eColorAttachmentOptimal}});
-        // Create render pass instance
-        vkw::UpdateRenderPass(device, g_ctx.render_pass_pack);
+    // Transform, clamp and cull all at once
+    TransformClipRects(culling, clip_off, clip_scale, draw_size);
 
-        if (bg_img_view) {
-            // Create pipeline (BG)
-            vkw::PipelineInfo bg_pipeline_info;
-            bg_pipeline_info.color_blend_infos.resize(1);
-            bg_pipeline_info.depth_test_enable = false;
-            g_ctx.bg_pipeline_pack = vkw::CreateGraphicsPipeline(
-                    device,
-                    {g_ctx.bg_vert_shader_pack, g_ctx.bg_frag_shader_pack}, {},
-                    {}, bg_pipeline_info, {g_ctx.bg_desc_set_pack},
-                    g_ctx.render_pass_pack, 0);
-        }
-        // Create pipeline (ImGui)
-        vkw::PipelineColorBlendAttachInfo imgui_pipeine_blend_info;
-        imgui_pipeine_blend_info.blend_enable = true;
-        vkw::PipelineInfo imgui_pipeline_info;
-        imgui_pipeline_info.color_blend_infos = {imgui_pipeine_blend_info};
-        imgui_pipeline_info.depth_test_enable = false;
-        imgui_pipeline_info.face_culling = vk::CullModeFlagBits::eNone;
-        g_ctx.imgui_pipeline_pack = vkw::CreateGraphicsPipeline(
-                device,
-                {g_ctx.imgui_vert_shader_pack, g_ctx.imgui_frag_shader_pack},
-                {{0, sizeof(ImDrawVert), vk::VertexInputRate::eVertex}},
-                {{0, 0, vk::Format::eR32G32Sfloat, offsetof(ImDrawVert, pos)},
-                 {1, 0, vk::Format::eR32G32Sfloat, offsetof(ImDrawVert, uv)},
-                 {2, 0, vk::Format::eR8G8B8A8Unorm, offsetof(ImDrawVert, col)}},
-                imgui_pipeline_info, {g_ctx.imgui_desc_set_pack},
-                g_ctx.render_pass_pack, bg_img_view ? 1 : 0);
+    // Compact
+    culling.draws.clear();
+    uint32_t last_rect_idx = NO_RECT;  // Scissor is set again after callbacks
+    for (size_t i = 0; i < cmds.size(); i++) {
+        const uint32_t rect_idx = culling.rect_idxs[i];
+        VisibleDraw draw;
+        draw.cmd = &cmds[i];
+        if (rect_idx != NO_RECT) {
+            if (!culling.visible_masks[rect_idx]) {
+                g_ctx.frame_stats.n_culled_cmds++;
+                continue;
+            }
+            draw.scissor = vk::Rect2D{
+                    {culling.offset_xs[rect_idx], culling.offset_ys[rect_idx]},
+                    {static_cast<uint32_t>(culling.extent_ws[rect_idx]),
+                     static_cast<uint32_t>(culling.extent_hs[rect_idx])}};
+            draw.is_scissor_changed = (rect_idx != last_rect_idx);
+        }
+        last_rect_idx = rect_idx;
+        culling.draws.push_back(draw);
     }
+}
 
-    // Create frame buffer
-    const Context::FrameBufKey& key = {&dst_img_view, &dst_img_size};
-    auto& frame_buf = g_ctx.frame_buf_map[key];
-    if (!frame_buf || needs_update) {
-        // Create & Register
-        frame_buf = CreateFrameBuffer(device, g_ctx.render_pass_pack,
-                                      {dst_img_view}, dst_img_size);
+// Records the output of `CullDrawCmds`
+template <typename F>
+void RecordVisibleDraws(const vk::UniqueCommandBuffer& dst_cmd_buf,
+                        const F& run_user_callback) {
+    auto& stats = g_ctx.frame_stats;
+    // Raw handles are cached out of the loop
+    const vk::CommandBuffer cmd_buf = dst_cmd_buf.get();
+    const vk::Pipeline imgui_pipeline =
+            g_ctx.imgui_pipeline_pack->pipeline.get();
+    const auto& quad_pipeline_pack = g_ctx.quad_pipeline_pack;
+    const vk::Pipeline quad_pipeline =
+            quad_pipeline_pack ? quad_pipeline_pack->pipeline.get() :
+                                 vk::Pipeline();
+    const vk::PipelineLayout pipeline_layout =
+            g_ctx.imgui_pipeline_pack->pipeline_layout.get();
+    bool is_quad_bound = false;
+    vk::DescriptorSet bound_tex_set;
+    for (auto&& draw : g_ctx.clip_culling.draws) {
+        const PackedCmd& cmd = *draw.cmd;
+        if (cmd.pcmd->UserCallback != nullptr) {
+            run_user_callback(cmd.cmd_list, cmd.pcmd);
+            is_quad_bound = false;  // ImGui pipeline after reset
+            bound_tex_set = vk::DescriptorSet();
+            continue;
+        }
+        if (draw.is_scissor_changed) {
+            cmd_buf.setScissor(0, draw.scissor);
+            stats.n_scissor_calls++;
+        }
+        if (is_quad_bound != cmd.is_quads) {
+            is_quad_bound = cmd.is_quads;
+            cmd_buf.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                                 is_quad_bound ? quad_pipeline :
+                                                 imgui_pipeline);
+            stats.n_bind_calls++;
+        }
+        // Atlas entries of one page share the set (Layouts are compatible
+        // between ImGui and quad pipelines)
+        const Texture& tex = ResolveTexture(cmd.pcmd->TextureId);
+        const vk::DescriptorSet tex_set = tex.desc_set->desc_set;
+        if (bound_tex_set != tex_set) {
+            bound_tex_set = tex_set;
+            cmd_buf.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                       pipeline_layout, 1, tex_set, nullptr);
+            stats.n_bind_calls++;
+        }
+        if (cmd.is_quads) {
+            cmd_buf.draw(6, cmd.count, 0, cmd.first);
+        } else {
+            cmd_buf.drawIndexed(cmd.count, 1, cmd.first, cmd.vtx_offset, 0);
+        }
+        stats.n_draw_calls++;
     }
-    return frame_buf;
 }
 
-void UpdateUnifBuf(ImDrawData* draw_data) {
-    auto&& device = *g_ctx.device_p;
+// Records ImGui commands into the current subpass of `frame_buf`
+void RecordImGuiCmds(const vk::UniqueCommandBuffer& dst_cmd_buf,
+                     ImDrawData* draw_data, const ImVec2& draw_size,
+                     const ImVec2& clip_scale,
+                     const vkw::FrameBufferPackPtr& frame_buf) {
+    auto& stats = g_ctx.frame_stats;
+    SetupRenderState(dst_cmd_buf, frame_buf);
+    const ImVec2& clip_off = draw_data->DisplayPos;
 
-    // Send to uniform buffer
-    auto& unif_buf = g_ctx.unif_buf;
-    unif_buf.scale[0] = 2.f / draw_data->DisplaySize.x;
-    unif_buf.scale[1] = 2.f / draw_data->DisplaySize.y;
-    unif_buf.shift[0] = -1.f - draw_data->DisplayPos.x * unif_buf.scale[0];
-    unif_buf.shift[1] = -1.f - draw_data->DisplayPos.y * unif_buf.scale[1];
-    vkw::SendToDevice(device, g_ctx.unif_buf_pack, &unif_buf, sizeof(UnifBuf));
+    // State exposed to user callbacks
+    auto& render_state = g_ctx.render_state;
+    render_state.cmd_buf = dst_cmd_buf.get();
+    render_state.render_pass = g_ctx.imgui_render_pass_pack->render_pass.get();
+    render_state.subpass_idx = g_ctx.imgui_subpass_idx;
+    render_state.pipeline = g_ctx.imgui_pipeline_pack->pipeline.get();
+    render_state.pipeline_layout =
+            g_ctx.imgui_pipeline_pack->pipeline_layout.get();
+    render_state.fb_size = vk::Extent2D{frame_buf->width, frame_buf->height};
+    render_state.display_pos = clip_off;
+    render_state.fb_scale = clip_scale;
+    auto run_user_callback = [&](const ImDrawList* cmd_list,
+                                 const ImDrawCmd* pcmd) {
+        if (pcmd->UserCallback == ImDrawCallback_ResetRenderState) {
+            SetupRenderState(dst_cmd_buf, frame_buf);
+        } else {
+            // Callback can record into the same subpass
+            ObtainScissor(pcmd, clip_off, clip_scale, draw_size,
+                          render_state.scissor);
+            g_ctx.is_in_callback = true;
+            pcmd->UserCallback(cmd_list, pcmd);
+            g_ctx.is_in_callback = false;
+        }
+        stats.n_user_callbacks++;
+    };
+
+    // Culling pre-pass, then a tight recording loop
+    if (g_ctx.instanced_quads) {
+        CullDrawCmds(g_ctx.quad_packing.cmds, clip_off, clip_scale, draw_size);
+    } else {
+        GatherListCmds(draw_data);
+        CullDrawCmds(g_ctx.clip_culling.list_cmds, clip_off, clip_scale,
+                     draw_size);
+    }
+    RecordVisibleDraws(dst_cmd_buf, run_user_callback);
+}
+
+// Draws ImGui into the reduced overlay target, which is left for sampling
+void RecordOverlayPass(const vk::UniqueCommandBuffer& dst_cmd_buf,
+                       ImDrawData* draw_data, const ImVec2& draw_size,
+                       const vk::Extent2D& dst_img_size) {
+    const auto& target = *g_ctx.overlay_target;
+    const vk::ImageSubresourceRange subres_range = {
+            vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+    // Waits for the composite of the previous frame (Contents are discarded)
+    const vk::ImageMemoryBarrier to_color = {
+            {},
+            vk::AccessFlagBits::eColorAttachmentWrite,
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            target.img->img.get(),
+            subres_range};
+    dst_cmd_buf->pipelineBarrier(
+            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, nullptr,
+            nullptr, to_color);
+
+    // Cleared to transparent, blended with premultiplied alpha
+    const vk::ClearValue clear_val =
+            vk::ClearColorValue(std::array<float, 4>{{0.f, 0.f, 0.f, 0.f}});
+    CmdBeginPass(dst_cmd_buf.get(), target.render_pass_pack, target.frame_buf,
+                 &clear_val);
+    // Scissors are scaled, while `UnifBuf` maps the display onto the
+    // viewport of any size as it is
+    const ImVec2 ratio = {static_cast<float>(target.img->size.width) /
+                                  static_cast<float>(dst_img_size.width),
+                          static_cast<float>(target.img->size.height) /
+                                  static_cast<float>(dst_img_size.height)};
+    const ImVec2& fb_scale = draw_data->FramebufferScale;
+    RecordImGuiCmds(dst_cmd_buf, draw_data,
+                    {draw_size.x * ratio.x, draw_size.y * ratio.y},
+                    {fb_scale.x * ratio.x, fb_scale.y * ratio.y},
+                    target.frame_buf);
+    dst_cmd_buf->endRenderPass();
+
+    const vk::ImageMemoryBarrier to_shader = {
+            vk::AccessFlagBits::eColorAttachmentWrite,
+            vk::AccessFlagBits::eShaderRead,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            target.img->img.get(),
+            subres_range};
+    dst_cmd_buf->pipelineBarrier(
+            vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            vk::PipelineStageFlagBits::eFragmentShader, {}, nullptr, nullptr,
+            to_shader);
 }
 
 void RecordDrawCmds(const vk::UniqueCommandBuffer& dst_cmd_buf,
                     ImDrawData* draw_data, const ImVec2& draw_size,
                     const vkw::FrameBufferPackPtr& frame_buf) {
+    const vk::CommandBuffer cmd_buf = dst_cmd_buf.get();
+    const vk::Extent2D dst_img_size = {frame_buf->width, frame_buf->height};
+
+    // GPU timing (Must be reset outside of render pass)
+    const uint32_t query_base = BeginGpuTiming(dst_cmd_buf);
+    WriteGpuTimestamp(dst_cmd_buf, query_base, TIMESTAMP_BEGIN,
+                      vk::PipelineStageFlagBits::eTopOfPipe);
+
+    // BG by transfer (Must be outside of render pass)
+    if (g_ctx.bg_img_view && !g_ctx.has_bg_pass) {
+        CmdTransferBg(dst_cmd_buf, dst_img_size);
+    }
+
+    // Reduced overlay is drawn before the destination pass, which composites
+    // it. (ImGui time also includes BG subpass in this case)
+    const bool has_overlay = g_ctx.imgui_pipeline_pack && g_ctx.overlay_target;
+    if (has_overlay) {
+        WriteGpuTimestamp(dst_cmd_buf, query_base, TIMESTAMP_BG_END,
+                          vk::PipelineStageFlagBits::eBottomOfPipe);
+        RecordOverlayPass(dst_cmd_buf, draw_data, draw_size, dst_img_size);
+    }
+
     // Begin render pass
-    vkw::CmdBeginRenderPass(dst_cmd_buf, g_ctx.render_pass_pack, frame_buf, {});
-    vkw::CmdSetViewport(dst_cmd_buf,
-                        vk::Extent2D{frame_buf->width, frame_buf->height});
-
-    // BG pass
-    if (g_ctx.bg_img_view) {
-        vkw::CmdSetScissor(dst_cmd_buf,
-                           vk::Extent2D{frame_buf->width, frame_buf->height});
-        vkw::CmdBindPipeline(dst_cmd_buf, g_ctx.bg_pipeline_pack);
-        vkw::CmdBindDescSets(dst_cmd_buf, g_ctx.bg_pipeline_pack,
-                             {g_ctx.bg_desc_set_pack});
-        vkw::CmdDraw(dst_cmd_buf, 3);
-        vkw::CmdNextSubPass(dst_cmd_buf);
-    }
-    // ImGui pass
-    vkw::CmdBindPipeline(dst_cmd_buf, g_ctx.imgui_pipeline_pack);
-    vkw::CmdBindDescSets(dst_cmd_buf, g_ctx.imgui_pipeline_pack,
-                         {g_ctx.imgui_desc_set_pack}, {0});
-    vkw::CmdBindVertexBuffers(dst_cmd_buf, 0, {g_ctx.vtx_buf_pack});
-    vkw::CmdBindIndexBuffer(dst_cmd_buf, g_ctx.idx_buf_pack, 0, IDX_TYPE);
-    const ImVec2& clip_off = draw_data->DisplayPos;
-    const ImVec2& clip_scale = draw_data->FramebufferScale;
-    uint32_t global_vtx_offset = 0;
-    uint32_t global_idx_offset = 0;
-    for (int n = 0; n < draw_data->CmdListsCount; n++) {
-        const ImDrawList* cmd_list = draw_data->CmdLists[n];
-        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++) {
-            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
-            if (pcmd->UserCallback != nullptr) {
-                if (pcmd->UserCallback == ImDrawCallback_ResetRenderState) {
-                    // TODO: Reset render state
-                } else {
-                    pcmd->UserCallback(cmd_list, pcmd);
-                }
-            } else {
-                ImVec4 clip_rect = {
-                        (pcmd->ClipRect.x - clip_off.x) * clip_scale.x,
-                        (pcmd->ClipRect.y - clip_off.y) * clip_scale.y,
-                        (pcmd->ClipRect.z - clip_off.x) * clip_scale.x,
-                        (pcmd->ClipRect.w - clip_off.y) * clip_scale.y};
+    CmdBeginPass(cmd_buf, g_ctx.render_pass_pack, frame_buf, nullptr);
+    CmdSetFullViewport(cmd_buf, dst_img_size);
 
-                if (clip_rect.x < draw_size.x && clip_rect.y < draw_size.y &&
-                    0 <= clip_rect.z && 0 <= clip_rect.w) {
-                    // Negative offsets are illegal for vkCmdSetScissor
-                    clip_rect.x = std::max(clip_rect.x, 0.f);
-                    clip_rect.y = std::max(clip_rect.y, 0.f);
-
-                    // Apply scissor/clipping rectangle
-                    vk::Rect2D scissor = {
-                            {static_cast<int32_t>(clip_rect.x),
-                             static_cast<int32_t>(clip_rect.y)},
-                            {static_cast<uint32_t>(clip_rect.z - clip_rect.x),
-                             static_cast<uint32_t>(clip_rect.w - clip_rect.y)}};
-                    vkw::CmdSetScissor(dst_cmd_buf, scissor);
-
-                    // Draw
-                    vkw::CmdDrawIndexed(dst_cmd_buf,
-                                        static_cast<uint32_t>(pcmd->ElemCount),
-                                        1, pcmd->IdxOffset + global_idx_offset,
-                                        static_cast<int32_t>(pcmd->VtxOffset +
-                                                             global_vtx_offset),
-                                        0);
-                }
-            }
-        }
-        global_idx_offset += static_cast<uint32_t>(cmd_list->IdxBuffer.Size);
-        global_vtx_offset += static_cast<uint32_t>(cmd_list->VtxBuffer.Size);
+    // BG pass (Also while ImGui pipelines are compiling)
+    if (g_ctx.has_bg_pass) {
+        CmdDrawFullscreen(cmd_buf, g_ctx.bg_pipeline_pack,
+                          g_ctx.bg_desc_set->desc_set, dst_img_size);
+        cmd_buf.nextSubpass(vk::SubpassContents::eInline);
+    }
+
+    if (!g_ctx.imgui_pipeline_pack) {
+        // Pipelines are compiling -> Only BG (or the layout transition)
+        WriteGpuTimestamp(dst_cmd_buf, query_base, TIMESTAMP_BG_END,
+                          vk::PipelineStageFlagBits::eBottomOfPipe);
+        cmd_buf.endRenderPass();
+        WriteGpuTimestamp(dst_cmd_buf, query_base, TIMESTAMP_IMGUI_END,
+                          vk::PipelineStageFlagBits::eBottomOfPipe);
+        return;
+    }
+
+    if (has_overlay) {
+        // Upscale with filtering
+        CmdDrawFullscreen(cmd_buf, g_ctx.composite_pipeline_pack,
+                          g_ctx.overlay_target->desc_set->desc_set,
+                          dst_img_size);
+    } else {
+        WriteGpuTimestamp(dst_cmd_buf, query_base, TIMESTAMP_BG_END,
+                          vk::PipelineStageFlagBits::eBottomOfPipe);
+        // ImGui pass
+        RecordImGuiCmds(dst_cmd_buf, draw_data, draw_size,
+                        draw_data->FramebufferScale, frame_buf);
     }
 
     // End render pass
-    vkw::CmdEndRenderPass(dst_cmd_buf);
+    cmd_buf.endRenderPass();
+    WriteGpuTimestamp(dst_cmd_buf, query_base, TIMESTAMP_IMGUI_END,
+                      vk::PipelineStageFlagBits::eBottomOfPipe);
+}
+
+// Records a frame into a command buffer in recording state
+// (Returns false when nothing is drawn)
+bool RecordFrame(ImDrawData* draw_data,
+                 const vk::UniqueCommandBuffer& dst_cmd_buf,
+                 const vk::ImageView& dst_img_view,
+                 const vk::Format& dst_img_format,
+                 const vk::Extent2D& dst_img_size,
+                 const vk::ImageLayout& dst_final_layout,
+                 const vk::ImageView& bg_img_view,
+                 const vk::ImageLayout& bg_img_layout) {
+    // Clear statistics of the previous frame
+    auto& stats = g_ctx.frame_stats;
+    stats = {};
+
+    // Release objects which are no longer used by GPU
+    AdvanceFrame();
+
+    // Send font texture and pending atlas entries
+    {
+        ScopedTimer timer(stats.update_font_tex_us);
+        IMGUI_IMPL_VULKANHPP_TRACE_ZONE("UpdateFontTex");
+        UpdateFontTex(dst_cmd_buf);
+        UploadAtlasPages(dst_cmd_buf);
+        UploadStreamingTexs(dst_cmd_buf);
+    }
+
+    // Compute framebuffer size
+    const auto draw_size = ObtainImDrawSize(draw_data);
+    if (draw_size.x <= 0.f || draw_size.y <= 0.f) {
+        return false;  // Nothing is drawn
+    }
+
+    // Update vertex and index buffers
+    bool upd_buf_ret = false;
+    {
+        ScopedTimer timer(stats.update_vtx_idx_bufs_us);
+        IMGUI_IMPL_VULKANHPP_TRACE_ZONE("UpdateVtxIdxBufs");
+        upd_buf_ret = UpdateVtxIdxBufs(draw_data);
+    }
+    if (!upd_buf_ret) {
+        return false;  // Nothing is drawn
+    }
+
+    // Create Rendering Pipeline
+    vkw::FrameBufferPackPtr frame_buf;
+    {
+        ScopedTimer timer(stats.update_render_pipeline_us);
+        IMGUI_IMPL_VULKANHPP_TRACE_ZONE("UpdateRenderPipeline");
+        frame_buf = UpdateRenderPipeline(dst_img_format, dst_img_view,
+                                         dst_img_size, dst_final_layout,
+                                         bg_img_view, bg_img_layout);
+    }
+
+    // Update uniform buffer
+    {
+        ScopedTimer timer(stats.update_unif_buf_us);
+        IMGUI_IMPL_VULKANHPP_TRACE_ZONE("UpdateUnifBuf");
+        UpdateUnifBuf(draw_data);
+    }
+
+    // Record commands
+    {
+        ScopedTimer timer(stats.record_draw_cmds_us);
+        IMGUI_IMPL_VULKANHPP_TRACE_ZONE("RecordDrawCmds");
+        RecordDrawCmds(dst_cmd_buf, draw_data, draw_size, frame_buf);
+    }
+    return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -419,6 +3607,8 @@ IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_Init() {
     // Set backend name
     ImGuiIO& io = ImGui::GetIO();
     io.BackendRendererName = "imgui_impl_vulkanhpp";
+    // Draw lists over 64K vertices are split by `VtxOffset`, not asserted
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
 
     // Turn on fetched flag.
     int32_t width = 0, height = 0;
@@ -431,6 +3621,9 @@ IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_Init() {
 }
 
 IMGUI_IMPL_API void ImGui_ImplVulkanHpp_Shutdown() {
+    ImGuiIO& io = ImGui::GetIO();
+    io.BackendFlags &= ~ImGuiBackendFlags_RendererHasVtxOffset;
+
     // Clear global context
     g_ctx = {};
 }
@@ -438,12 +3631,24 @@ IMGUI_IMPL_API void ImGui_ImplVulkanHpp_Shutdown() {
 IMGUI_IMPL_API void ImGui_ImplVulkanHpp_NewFrame(
         const vk::PhysicalDevice& physical_device,
         const vk::UniqueDevice& device) {
+    IMGUI_IMPL_VULKANHPP_TRACE_ZONE("NewFrame");
+
+    // Plots and BG images are collected for each frame
+    g_ctx.plot_descs.clear();
+    g_ctx.bg_imgs = {};
+
     if (g_ctx.physical_device_p == &physical_device &&
         g_ctx.device_p == &device) {
         // Already initialized -> Skip
         return;
     }
 
+    // Objects of the previous device go before any of the new one
+    if (g_ctx.device_p) {
+        ClearRenderPipelineCaches();
+        ReleasePooledObjects();
+    }
+
     // Set to global context
     g_ctx.physical_device_p = &physical_device;
     g_ctx.device_p = &device;
@@ -456,52 +3661,228 @@ IMGUI_IMPL_API void ImGui_ImplVulkanHpp_NewFrame(
             device, BG_FRAG_SOURCE, vk::ShaderStageFlagBits::eFragment);
     g_ctx.imgui_vert_shader_pack = glsl_compiler.compileFromString(
             device, IMGUI_VERT_SOURCE, vk::ShaderStageFlagBits::eVertex);
+    g_ctx.imgui_compact_vert_shader_pack = glsl_compiler.compileFromString(
+            device, IMGUI_COMPACT_VERT_SOURCE,
+            vk::ShaderStageFlagBits::eVertex);
+    g_ctx.imgui_pull_vert_shader_pack = glsl_compiler.compileFromString(
+            device, IMGUI_PULL_VERT_SOURCE, vk::ShaderStageFlagBits::eVertex);
+    g_ctx.imgui_pull_compact_vert_shader_pack =
+            glsl_compiler.compileFromString(device,
+                                            IMGUI_PULL_COMPACT_VERT_SOURCE,
+                                            vk::ShaderStageFlagBits::eVertex);
     g_ctx.imgui_frag_shader_pack = glsl_compiler.compileFromString(
             device, IMGUI_FRAG_SOURCE, vk::ShaderStageFlagBits::eFragment);
+    g_ctx.imgui_quad_vert_shader_pack = glsl_compiler.compileFromString(
+            device, IMGUI_QUAD_VERT_SOURCE, vk::ShaderStageFlagBits::eVertex);
+    g_ctx.plot_line_vert_shader_pack = glsl_compiler.compileFromString(
+            device, PLOT_LINE_VERT_SOURCE, vk::ShaderStageFlagBits::eVertex);
+    g_ctx.plot_point_vert_shader_pack = glsl_compiler.compileFromString(
+            device, PLOT_POINT_VERT_SOURCE, vk::ShaderStageFlagBits::eVertex);
+    g_ctx.plot_frag_shader_pack = glsl_compiler.compileFromString(
+            device, PLOT_FRAG_SOURCE, vk::ShaderStageFlagBits::eFragment);
+
+    // Alignments for sub-allocation
+    const auto& limits = physical_device.getProperties().limits;
+    g_ctx.min_unif_offset_align =
+            static_cast<size_t>(limits.minUniformBufferOffsetAlignment);
+    g_ctx.min_storage_offset_align =
+            static_cast<size_t>(limits.minStorageBufferOffsetAlignment);
+    g_ctx.non_coherent_atom_size =
+            static_cast<size_t>(limits.nonCoherentAtomSize);
+    g_ctx.mem_pool.mem_props = physical_device.getMemoryProperties();
 
-    // Create Uniform Buffer
-    g_ctx.unif_buf_pack =
-            vkw::CreateBufferPack(physical_device, device, sizeof(UnifBuf),
-                                  vk::BufferUsageFlagBits::eUniformBuffer,
-                                  vkw::HOST_VISIB_COHER_PROPS);
+    // Descriptor set (ImGui, Sets of each arena share this layout)
+    g_ctx.imgui_desc_set_pack = CreateImGuiDescSetPack();
+    g_ctx.imgui_desc_pools = CreateDescPoolChain(
+            g_ctx.imgui_desc_set_pack,
+            {{vk::DescriptorType::eUniformBufferDynamic, 1},
+             {vk::DescriptorType::eStorageBufferDynamic, 2}});
+    // Descriptor set (Texture, Sets of each `ImTextureID` share this layout)
+    const std::vector<vk::DescriptorPoolSize> sampler_sizes = {
+            {vk::DescriptorType::eCombinedImageSampler, 1}};
+    g_ctx.tex_layout_desc_set_pack = vkw::CreateDescriptorSetPack(
+            device, {{vk::DescriptorType::eCombinedImageSampler, 1,
+                      vk::ShaderStageFlagBits::eFragment}});
+    g_ctx.tex_desc_pools =
+            CreateDescPoolChain(g_ctx.tex_layout_desc_set_pack, sampler_sizes);
+    // Descriptor set (BG, Sets for each BG image share this layout)
+    g_ctx.bg_layout_desc_set_pack = vkw::CreateDescriptorSetPack(
+            device, {{vk::DescriptorType::eCombinedImageSampler, 1,
+                      vk::ShaderStageFlagBits::eFragment}});  // BG texture
+    g_ctx.bg_desc_pools =
+            CreateDescPoolChain(g_ctx.bg_layout_desc_set_pack, sampler_sizes);
 
     // Create font texture
     ImGuiIO& io = ImGui::GetIO();
     int32_t width = 0, height = 0;
     io.Fonts->GetTexDataAsRGBA32(&g_ctx.font_pixel_p, &width, &height);
     g_ctx.font_pixel_size = static_cast<size_t>(width * height) * 4;
-    // Create Texture
-    g_ctx.font_img_pack = vkw::CreateImagePack(
-            physical_device, device, vk::Format::eR8G8B8A8Unorm,
-            {static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, 1,
+    // Create Texture (Sub-allocated from the memory pool)
+    g_ctx.font_img = CreatePooledImage(
+            vk::Format::eR8G8B8A8Unorm,
+            {static_cast<uint32_t>(width), static_cast<uint32_t>(height)},
             vk::ImageUsageFlagBits::eSampled |
                     vk::ImageUsageFlagBits::eTransferDst);
-    g_ctx.font_tex_pack = vkw::CreateTexturePack(g_ctx.font_img_pack, device);
-    io.Fonts->TexID = static_cast<ImTextureID>(g_ctx.font_img_pack.get());
-
-    // Descriptor set (BG)
-    g_ctx.bg_desc_set_pack = vkw::CreateDescriptorSetPack(
-            device, {{vk::DescriptorType::eCombinedImageSampler, 1,
-                      vk::ShaderStageFlagBits::eFragment}});  // BG texture
-    // Descriptor set (ImGui)
-    g_ctx.imgui_desc_set_pack = vkw::CreateDescriptorSetPack(
-            device, {{vk::DescriptorType::eUniformBufferDynamic, 1,
-                      vk::ShaderStageFlagBits::eVertex},  // Uniform buffer
-                     {vk::DescriptorType::eCombinedImageSampler, 1,
-                      vk::ShaderStageFlagBits::eFragment}});  // Font texture
-    // Bind descriptor set with actual buffer (ImGui)
-    g_ctx.imgui_write_desc_set_pack = vkw::CreateWriteDescSetPack();
-    vkw::AddWriteDescSet(g_ctx.imgui_write_desc_set_pack,
-                         g_ctx.imgui_desc_set_pack, 0, {g_ctx.unif_buf_pack});
-    vkw::AddWriteDescSet(g_ctx.imgui_write_desc_set_pack,
-                         g_ctx.imgui_desc_set_pack, 1, {g_ctx.font_tex_pack},
-                         {vk::ImageLayout::eShaderReadOnlyOptimal});
-    vkw::UpdateDescriptorSets(device, g_ctx.imgui_write_desc_set_pack);
+    g_ctx.font_sampler = vkw::CreateSampler(device);
+    g_ctx.font_tex = std::make_shared<Texture>();
+    g_ctx.font_tex->desc_set = CreateTexDescSet(
+            g_ctx.font_sampler.get(), g_ctx.font_img->view.get(),
+            vk::ImageLayout::eShaderReadOnlyOptimal);
+    io.Fonts->TexID = static_cast<ImTextureID>(g_ctx.font_tex.get());
 
     // Texture Sampler (BG)
     g_ctx.bg_sampler = vkw::CreateSampler(device);
 }
 
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_SetOptions(
+        const ImGui_ImplVulkanHpp_Options& options) {
+    g_ctx.options = options;
+}
+
+IMGUI_IMPL_API const ImGui_ImplVulkanHpp_Options&
+ImGui_ImplVulkanHpp_GetOptions() {
+    return g_ctx.options;
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_ForgetTarget(
+        const vk::ImageView& img_view) {
+    RetireFrameBufs(img_view);
+    // Also as BG (A recycled handle must not skip writing a new set)
+    if (img_view && g_ctx.bg_img_view == img_view) {
+        g_ctx.bg_img_view = vk::ImageView();
+        Retire(std::move(g_ctx.bg_desc_set), g_ctx.frame_idx);
+    }
+}
+
+IMGUI_IMPL_API const ImGui_ImplVulkanHpp_FrameStats&
+ImGui_ImplVulkanHpp_GetFrameStats() {
+    return g_ctx.frame_stats;
+}
+
+IMGUI_IMPL_API const ImGui_ImplVulkanHpp_RenderState*
+ImGui_ImplVulkanHpp_GetRenderState() {
+    return g_ctx.is_in_callback ? &g_ctx.render_state : nullptr;
+}
+
+IMGUI_IMPL_API vk::DescriptorSet ImGui_ImplVulkanHpp_AllocFrameDescSet(
+        const vk::DescriptorSetLayout& layout) {
+    if (!g_ctx.is_in_callback) {
+        return {};
+    }
+    return AllocFromChain(*GetCurrArena().frame_desc_pools, layout);
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_SetBgImages(
+        const ImGui_ImplVulkanHpp_BgImages& bg_imgs) {
+    g_ctx.bg_imgs = bg_imgs;
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_AddPlot(
+        ImDrawList* draw_list, const ImGui_ImplVulkanHpp_PlotDesc& desc) {
+    const size_t plot_idx = g_ctx.plot_descs.size();
+    g_ctx.plot_descs.push_back(desc);
+    draw_list->AddCallback(DrawPlot, reinterpret_cast<void*>(plot_idx));
+    draw_list->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_PrewarmPipelines(
+        const ImGui_ImplVulkanHpp_PipelineDesc* descs, int n_descs) {
+    using VertexFormat = ImGui_ImplVulkanHpp_VertexFormat;
+    const VertexFormat vtx_format = g_ctx.options.vertex_format;
+    const float scale = g_ctx.options.overlay_scale;
+    const bool has_overlay = (0.f < scale && scale < 1.f);
+    for (int i = 0; i < n_descs; i++) {
+        const auto& desc = descs[i];
+        ObtainPipelineSet(desc.dst_img_format, desc.dst_final_layout,
+                          desc.has_bg, has_overlay, vtx_format, true);
+        if (vtx_format != VertexFormat::Float) {
+            // Fallback for frames out of the compact range
+            ObtainPipelineSet(desc.dst_img_format, desc.dst_final_layout,
+                              desc.has_bg, has_overlay, VertexFormat::Float,
+                              true);
+        }
+        if (desc.has_bg) {
+            // Synchronous, but tiny
+            ObtainBgPipeline(ObtainRenderPass(desc.dst_img_format,
+                                              vk::ImageLayout::eUndefined,
+                                              desc.dst_final_layout, true));
+        }
+    }
+}
+
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_WriteTrace(const char* filename) {
+#if defined(IMGUI_IMPL_VULKANHPP_TRACE)
+    FILE* fp = std::fopen(filename, "w");
+    if (!fp) {
+        return false;
+    }
+    // Buffers are registered concurrently, so the list is copied first
+    std::vector<TraceBufferPtr> buffers;
+    {
+        auto& registry = GetTraceRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        buffers = registry.buffers;
+    }
+    std::fprintf(fp, "{\"traceEvents\": [\n");
+    bool is_first = true;
+    for (auto&& buffer : buffers) {
+        WriteTraceBuffer(fp, *buffer, is_first);
+    }
+    std::fprintf(fp, "\n], \"displayTimeUnit\": \"ms\"}\n");
+    return std::fclose(fp) == 0;
+#else
+    (void)filename;
+    return false;  // Compiled out
+#endif
+}
+
+IMGUI_IMPL_API uint64_t ImGui_ImplVulkanHpp_GetFrameIndex() {
+    return g_ctx.frame_idx;
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_SetCompletedFrameIndex(
+        uint64_t frame_idx) {
+    g_ctx.is_frame_tracked = true;
+    g_ctx.completed_frame_idx = std::max(g_ctx.completed_frame_idx, frame_idx);
+    CollectRetired();
+}
+
+IMGUI_IMPL_API ImGui_ImplVulkanHpp_MemoryStats
+ImGui_ImplVulkanHpp_GetMemoryStats() {
+    ImGui_ImplVulkanHpp_MemoryStats mem_stats;
+    const auto& pool = g_ctx.mem_pool;
+    for (auto&& block : pool.blocks) {
+        const auto& mem_type = pool.mem_props.memoryTypes[block->mem_type_idx];
+        if (mem_type.propertyFlags & vk::MemoryPropertyFlagBits::eDeviceLocal) {
+            mem_stats.device_local_bytes += block->size;
+        }
+        mem_stats.reserved_bytes += block->size;
+        mem_stats.used_bytes += block->used;
+        mem_stats.n_allocs += block->n_allocs;
+    }
+    mem_stats.n_blocks = static_cast<uint32_t>(pool.blocks.size());
+
+    // Descriptor pools (Long-lived chains and transient ones of arenas)
+    AddDescPoolStats(g_ctx.imgui_desc_pools, mem_stats);
+    AddDescPoolStats(g_ctx.tex_desc_pools, mem_stats);
+    AddDescPoolStats(g_ctx.bg_desc_pools, mem_stats);
+    for (auto&& arena : g_ctx.arenas) {
+        AddDescPoolStats(arena.frame_desc_pools, mem_stats);
+    }
+    return mem_stats;
+}
+
+IMGUI_IMPL_API ImGui_ImplVulkanHpp_GpuTimings
+ImGui_ImplVulkanHpp_GetGpuTimings() {
+    const auto& timing = g_ctx.gpu_timing;
+    ImGui_ImplVulkanHpp_GpuTimings timings;
+    timings.bg = SummarizeTiming(timing.bg_samples);
+    timings.imgui = SummarizeTiming(timing.imgui_samples);
+    timings.total = SummarizeTiming(timing.total_samples);
+    timings.n_samples = static_cast<uint32_t>(timing.total_samples.n_values);
+    return timings;
+}
+
 IMGUI_IMPL_API void ImGui_ImplVulkanHpp_RenderDrawData(
         ImDrawData* draw_data, const vk::UniqueCommandBuffer& dst_cmd_buf,
         const vk::ImageView& dst_img_view, const vk::Format& dst_img_format,
@@ -510,38 +3891,270 @@ IMGUI_IMPL_API void ImGui_ImplVulkanHpp_RenderDrawData(
         const vk::ImageView& bg_img_view,
         const vk::ImageLayout& bg_img_layout) {
     // Reset and begin command buffer
-    vkw::ResetCommand(dst_cmd_buf);
-    vkw::BeginCommand(dst_cmd_buf, true);  // once command
+    BeginOnceCommand(dst_cmd_buf);
 
-    // Send font texture
-    UpdateFontTex(dst_cmd_buf);
+    RecordFrame(draw_data, dst_cmd_buf, dst_img_view, dst_img_format,
+                dst_img_size, dst_final_layout, bg_img_view, bg_img_layout);
 
-    // Compute framebuffer size
-    const auto draw_size = ObtainImDrawSize(draw_data);
-    if (draw_size.x <= 0.f || draw_size.y <= 0.f) {
-        vkw::EndCommand(dst_cmd_buf);  // Empty command
-        return;
+    dst_cmd_buf->end();
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_CreateOffscreenTargets(
+        const ImGui_ImplVulkanHpp_OffscreenDesc& desc) {
+    // Previous targets may be used by the last recorded frame
+    if (g_ctx.offscreen_ring) {
+        for (auto&& slot : g_ctx.offscreen_ring->slots) {
+            RetireFrameBufs(slot.img->view.get());
+        }
+        Retire(std::move(g_ctx.offscreen_ring), g_ctx.frame_idx);
     }
 
-    // Update vertex and index buffers
-    const bool upd_buf_ret = UpdateVtxIdxBufs(draw_data);
-    if (!upd_buf_ret) {
-        vkw::EndCommand(dst_cmd_buf);  // Empty command
-        return;
+    auto ring = std::make_shared<OffscreenRing>();
+    ring->desc = desc;
+    ring->row_bytes = GetPixelBytes(desc.format) * desc.size.width;
+    const size_t n_bytes = ring->row_bytes * desc.size.height;
+
+    // Cached memory makes reading from the host fast. (Coherent one is uncached
+    // on many devices)
+    vk::MemoryPropertyFlags props = vk::MemoryPropertyFlagBits::eHostVisible |
+                                    vk::MemoryPropertyFlagBits::eHostCached;
+    if (!HasMemType(props)) {
+        props = vk::MemoryPropertyFlagBits::eHostVisible |
+                vk::MemoryPropertyFlagBits::eHostCoherent;
     }
 
-    // Create Rendering Pipeline
-    auto frame_buf =
-            UpdateRenderPipeline(dst_img_format, dst_img_view, dst_img_size,
-                                 dst_final_layout, bg_img_view, bg_img_layout);
+    ring->slots.resize(std::max(desc.n_targets, 2u));
+    for (auto&& slot : ring->slots) {
+        if (desc.exportable) {
+            // Shared with an importer instead of reading back
+            slot.img = CreateExportableImage(desc.format, desc.size,
+                                             EXPORT_IMG_USAGE);
+            slot.ready_semaphore = CreateExportableSemaphore();
+            slot.release_semaphore = CreateExportableSemaphore();
+            continue;
+        }
+        slot.img = CreatePooledImage(
+                desc.format, desc.size,
+                vk::ImageUsageFlagBits::eColorAttachment |
+                        vk::ImageUsageFlagBits::eTransferSrc);
+        slot.readback_buf = CreatePooledBuffer(
+                n_bytes, vk::BufferUsageFlagBits::eTransferDst, props);
+    }
+    if (!desc.exportable) {
+        ring->is_coherent = IsCoherentMem(ring->slots[0].readback_buf->mem);
+    }
+    g_ctx.offscreen_ring = std::move(ring);
+}
 
-    // Update uniform buffer
-    UpdateUnifBuf(draw_data);
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_RenderDrawDataOffscreen(
+        ImDrawData* draw_data, const vk::UniqueCommandBuffer& dst_cmd_buf) {
+    if (!g_ctx.offscreen_ring) {
+        return false;
+    }
+    auto& ring = *g_ctx.offscreen_ring;
+    auto& slot = ring.slots[ring.next_idx];
+    if (g_ctx.completed_frame_idx < slot.frame_idx) {
+        // Still in flight -> Drop this frame instead of waiting
+        return false;
+    }
 
-    // Record commands
-    RecordDrawCmds(dst_cmd_buf, draw_data, draw_size, frame_buf);
+    // Reset and begin command buffer
+    BeginOnceCommand(dst_cmd_buf);
+
+    const auto& desc = ring.desc;
+    ring.last_submit = {};
+    if (slot.is_released) {
+        // Wait until the importer stops reading (Even if nothing is drawn,
+        // so that each release is consumed once)
+        CmdAcquireFromExternal(dst_cmd_buf, slot.img, desc.queue_family_idx);
+        ring.last_submit.wait_semaphore = slot.release_semaphore.get();
+        slot.is_released = false;
+    }
+    const vk::ImageLayout final_layout =
+            desc.exportable ? vk::ImageLayout::eShaderReadOnlyOptimal :
+                              vk::ImageLayout::eTransferSrcOptimal;
+    const bool is_drawn = RecordFrame(draw_data, dst_cmd_buf,
+                                      slot.img->view.get(), desc.format,
+                                      desc.size, final_layout, {},
+                                      vk::ImageLayout::eUndefined);
+    if (is_drawn) {
+        if (desc.exportable) {
+            CmdReleaseToExternal(dst_cmd_buf, slot.img, desc.queue_family_idx);
+            slot.is_released = true;
+        } else {
+            CmdReadbackImage(dst_cmd_buf, slot.img, slot.readback_buf);
+        }
+        slot.frame_idx = g_ctx.frame_idx;
+        ring.last_submit.target_idx = static_cast<uint32_t>(ring.next_idx);
+        ring.last_submit.signal_semaphore = slot.ready_semaphore.get();
+        ring.last_submit.is_drawn = true;
+        ring.next_idx = (ring.next_idx + 1) % ring.slots.size();
+    }
+
+    // Submitted even when nothing is drawn (Uploads are already recorded and
+    // marked as sent)
+    dst_cmd_buf->end();
+    return true;
+}
+
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_GetReadbackFrame(
+        ImGui_ImplVulkanHpp_ReadbackFrame& frame) {
+    if (!g_ctx.offscreen_ring || g_ctx.offscreen_ring->desc.exportable) {
+        return false;
+    }
+    // Newest completed slot
+    const auto& ring = *g_ctx.offscreen_ring;
+    const OffscreenSlot* newest = nullptr;
+    for (auto&& slot : ring.slots) {
+        if (slot.frame_idx != 0 &&
+            slot.frame_idx <= g_ctx.completed_frame_idx &&
+            (!newest || newest->frame_idx < slot.frame_idx)) {
+            newest = &slot;
+        }
+    }
+    if (!newest) {
+        return false;
+    }
+
+    const MemRange& mem = newest->readback_buf->mem;
+    if (!ring.is_coherent) {
+        InvalidateMem(mem);
+    }
+    frame.pixels = mem.mapped_p;
+    frame.size = ring.desc.size;
+    frame.format = ring.desc.format;
+    frame.row_bytes = ring.row_bytes;
+    frame.frame_idx = newest->frame_idx;
+    return true;
+}
+
+IMGUI_IMPL_API const ImGui_ImplVulkanHpp_OffscreenSubmit&
+ImGui_ImplVulkanHpp_GetOffscreenSubmit() {
+    static const ImGui_ImplVulkanHpp_OffscreenSubmit EMPTY_SUBMIT;
+    if (!g_ctx.offscreen_ring) {
+        return EMPTY_SUBMIT;
+    }
+    return g_ctx.offscreen_ring->last_submit;
+}
+
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_ExportTarget(
+        uint32_t target_idx, ImGui_ImplVulkanHpp_ExportedTarget& exported) {
+    if (!g_ctx.offscreen_ring || !g_ctx.offscreen_ring->desc.exportable ||
+        g_ctx.offscreen_ring->slots.size() <= target_idx) {
+        return false;
+    }
+    auto&& device = *g_ctx.device_p;
+    const auto& ring = *g_ctx.offscreen_ring;
+    const auto& slot = ring.slots[target_idx];
+    const MemRange& mem = slot.img->mem;
+    exported.mem_fd = device->getMemoryFdKHR(
+            {mem.block->dev_mem.get(), EXPORT_MEM_HANDLE_TYPE});
+    exported.mem_size = static_cast<vk::DeviceSize>(mem.block->size);
+    exported.semaphore_fd = device->getSemaphoreFdKHR(
+            {slot.ready_semaphore.get(), EXPORT_SEMAPHORE_HANDLE_TYPE});
+    exported.release_semaphore_fd = device->getSemaphoreFdKHR(
+            {slot.release_semaphore.get(), EXPORT_SEMAPHORE_HANDLE_TYPE});
+    exported.format = ring.desc.format;
+    exported.size = ring.desc.size;
+    exported.usage = EXPORT_IMG_USAGE;
+    return true;
+}
+
+IMGUI_IMPL_API ImTextureID ImGui_ImplVulkanHpp_AddTexture(
+        const vk::ImageView& img_view, const vk::ImageLayout& img_layout,
+        const vk::Sampler& sampler) {
+    auto tex = std::make_shared<Texture>();
+    tex->desc_set = CreateTexDescSet(
+            sampler ? sampler : g_ctx.font_sampler.get(), img_view, img_layout);
+    g_ctx.textures[tex.get()] = tex;
+    return static_cast<ImTextureID>(tex.get());
+}
+
+IMGUI_IMPL_API ImTextureID ImGui_ImplVulkanHpp_AddAtlasTexture(
+        const uint8_t* rgba, uint32_t width, uint32_t height) {
+    if (!rgba || width == 0 || height == 0) {
+        return nullptr;
+    }
+    TexturePtr tex;
+    if (width <= ATLAS_MAX_ENTRY_SIZE && height <= ATLAS_MAX_ENTRY_SIZE) {
+        tex = PackAtlasEntry(rgba, width, height);
+    } else {
+        // Own page without padding (Nothing to share)
+        tex = std::make_shared<Texture>();
+        tex->page = CreateAtlasPage({width, height}, false);
+        tex->page->uploads.push_back(
+                {CreatePaddedStaging(rgba, width, height, 0),
+                 {0, 0},
+                 {width, height}});
+        tex->desc_set = tex->page->desc_set;
+    }
+    MarkDirty(tex->page);
+    g_ctx.textures[tex.get()] = tex;
+    return static_cast<ImTextureID>(tex.get());
+}
+
+IMGUI_IMPL_API ImTextureID ImGui_ImplVulkanHpp_AddStreamingTexture(
+        const ImGui_ImplVulkanHpp_StreamingTexDesc& desc) {
+    auto stream = std::make_shared<StreamingTex>();
+    stream->img = CreatePooledImage(
+            desc.format, desc.size,
+            vk::ImageUsageFlagBits::eSampled |
+                    vk::ImageUsageFlagBits::eTransferDst);
+    stream->row_bytes = GetPixelBytes(desc.format) * desc.size.width;
+    stream->slots.resize(std::max(desc.n_slots, 2u));
+    for (auto&& slot : stream->slots) {
+        // Write-combined memory is fast for sequential writes
+        slot.buf = CreatePooledBuffer(stream->row_bytes * desc.size.height,
+                                      vk::BufferUsageFlagBits::eTransferSrc,
+                                      vkw::HOST_VISIB_COHER_PROPS);
+    }
+    g_ctx.streaming_texs.push_back(stream);
+
+    auto tex = std::make_shared<Texture>();
+    tex->desc_set =
+            CreateTexDescSet(g_ctx.font_sampler.get(), stream->img->view.get(),
+                             vk::ImageLayout::eShaderReadOnlyOptimal);
+    tex->stream = std::move(stream);
+    g_ctx.textures[tex.get()] = tex;
+    return static_cast<ImTextureID>(tex.get());
+}
 
-    vkw::EndCommand(dst_cmd_buf);
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_AcquireTextureUpdate(
+        ImTextureID tex_id, ImGui_ImplVulkanHpp_TextureUpdate& update) {
+    if (!tex_id || !ResolveTexture(tex_id).stream) {
+        return false;
+    }
+    auto& stream = *ResolveTexture(tex_id).stream;
+    if (stream.pending_idx == NO_SLOT) {
+        // Slots are used in order, so the next one is the oldest
+        const auto& slot = stream.slots[stream.next_idx];
+        if (g_ctx.completed_frame_idx < slot.frame_idx) {
+            return false;  // Still in flight
+        }
+        stream.pending_idx = stream.next_idx;
+        stream.next_idx = (stream.next_idx + 1) %
+                          static_cast<uint32_t>(stream.slots.size());
+    }
+    update.pixels = stream.slots[stream.pending_idx].buf->mem.mapped_p;
+    update.size = stream.img->size;
+    update.row_bytes = stream.row_bytes;
+    return true;
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_RemoveTexture(ImTextureID tex_id) {
+    auto it = g_ctx.textures.find(static_cast<const Texture*>(tex_id));
+    if (it == g_ctx.textures.end()) {
+        return;  // Font or unknown
+    }
+    if (it->second->stream) {
+        auto& streams = g_ctx.streaming_texs;
+        streams.erase(std::remove(streams.begin(), streams.end(),
+                                  it->second->stream),
+                      streams.end());
+    }
+    // May be used by the last recorded frame
+    Retire(std::move(it->second), g_ctx.frame_idx);
+    g_ctx.textures.erase(it);
 }
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,471 @@
+#include "imgui_impl_vulkanhpp_capture.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// --------------------------------- File Format -------------------------------
+// -----------------------------------------------------------------------------
+// [FileHeader]
+// [FrameHeader] ([ListHeader] [CmdRecord * n_cmds] [Vertices] [Indices]) * n
+// [FrameHeader] ...
+// Every section is padded to 8 bytes to reference it directly from memory.
+constexpr uint32_t FILE_MAGIC = 0x43485649;  // "IVHC"
+constexpr uint32_t FILE_VERSION = 1;
+constexpr uint32_t FRAME_MAGIC = 0x454d5246;  // "FRME"
+constexpr size_t ALIGNMENT = 8;
+
+enum CmdFlags : uint32_t {
+    CMD_FLAG_NONE = 0,
+    CMD_FLAG_RESET_RENDER_STATE = 1,  // ImDrawCallback_ResetRenderState
+    CMD_FLAG_USER_CALLBACK = 2,       // Any other callback (Not replayed)
+};
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vtx_stride;  // sizeof(ImDrawVert)
+    uint32_t idx_stride;  // sizeof(ImDrawIdx)
+};
+
+struct FrameHeader {
+    uint32_t magic;
+    uint32_t n_cmd_lists;
+    uint32_t total_vtx_count;
+    uint32_t total_idx_count;
+    float display_pos[2];
+    float display_size[2];
+    float framebuffer_scale[2];
+};
+
+struct ListHeader {
+    uint32_t n_cmds;
+    uint32_t n_vtxs;
+    uint32_t n_idxs;
+    uint32_t flags;  // Reserved
+};
+
+struct CmdRecord {
+    float clip_rect[4];
+    uint64_t tex_id;
+    uint32_t vtx_offset;
+    uint32_t idx_offset;
+    uint32_t elem_count;
+    uint32_t flags;  // CmdFlags
+};
+
+static_assert(sizeof(FileHeader) % ALIGNMENT == 0, "Invalid padding");
+static_assert(sizeof(FrameHeader) % ALIGNMENT == 0, "Invalid padding");
+static_assert(sizeof(ListHeader) % ALIGNMENT == 0, "Invalid padding");
+static_assert(sizeof(CmdRecord) % ALIGNMENT == 0, "Invalid padding");
+
+size_t AlignUp(size_t n_bytes) {
+    return (n_bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+// -----------------------------------------------------------------------------
+// ----------------------------------- Writer ----------------------------------
+// -----------------------------------------------------------------------------
+struct CaptureContext {
+    FILE* fp = nullptr;
+    std::vector<CmdRecord> cmd_records;
+};
+
+CaptureContext g_capture;
+
+bool WritePadded(FILE* fp, const void* data, size_t n_bytes) {
+    static const uint8_t ZEROS[ALIGNMENT] = {};
+    if (n_bytes != 0 && std::fwrite(data, n_bytes, 1, fp) != 1) {
+        return false;
+    }
+    const size_t n_pad = AlignUp(n_bytes) - n_bytes;
+    return n_pad == 0 || std::fwrite(ZEROS, n_pad, 1, fp) == 1;
+}
+
+// -----------------------------------------------------------------------------
+// ------------------------------- Memory Mapping ------------------------------
+// -----------------------------------------------------------------------------
+class MappedFile {
+public:
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const char* filename) {
+#if defined(_WIN32)
+        m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER size = {};
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+            return false;
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0,
+                                       nullptr);
+        if (!m_mapping) {
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(
+                MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        return m_data != nullptr;
+#else
+        m_fd = ::open(filename, O_RDONLY);
+        if (m_fd < 0) {
+            return false;
+        }
+        struct stat st = {};
+        if (fstat(m_fd, &st) != 0 || st.st_size <= 0) {
+            return false;
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(data);
+        return true;
+#endif
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+        if (0 <= m_fd) ::close(m_fd);
+        m_fd = -1;
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    const uint8_t* data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+private:
+#if defined(_WIN32)
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+// Bounds-checked sequential reader over the mapped file
+class Cursor {
+public:
+    Cursor(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    template <typename T>
+    const T* take(size_t count = 1) {
+        const size_t n_bytes = AlignUp(sizeof(T) * count);
+        if (m_size - m_pos < n_bytes) {
+            return nullptr;
+        }
+        const T* ret = reinterpret_cast<const T*>(m_data + m_pos);
+        m_pos += n_bytes;
+        return ret;
+    }
+
+    bool empty() const {
+        return m_pos == m_size;
+    }
+
+    size_t pos() const {
+        return m_pos;
+    }
+
+    void seek(size_t pos) {
+        m_pos = pos;
+    }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+};
+
+// Borrow mapped memory as ImVector without copying
+template <typename T>
+void BorrowVector(ImVector<T>& vec, const T* data, uint32_t size) {
+    vec.Data = const_cast<T*>(data);
+    vec.Size = static_cast<int>(size);
+    vec.Capacity = static_cast<int>(size);
+}
+
+template <typename T>
+void ReleaseVector(ImVector<T>& vec) {
+    vec.Data = nullptr;
+    vec.Size = 0;
+    vec.Capacity = 0;
+}
+
+}  // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// ------------------------------- Replay Context ------------------------------
+// -----------------------------------------------------------------------------
+struct ImGui_ImplVulkanHpp_Replay {
+    MappedFile file;
+    std::vector<size_t> frame_offsets;
+
+    // Reused for every frame
+    ImDrawData draw_data;
+    std::vector<std::unique_ptr<ImDrawList>> draw_lists;
+    std::vector<ImDrawList*> draw_list_ptrs;
+
+    ~ImGui_ImplVulkanHpp_Replay() {
+        // Mapped memory must not be freed by ImGui
+        for (auto&& draw_list : draw_lists) {
+            ReleaseVector(draw_list->VtxBuffer);
+            ReleaseVector(draw_list->IdxBuffer);
+        }
+    }
+};
+
+namespace {
+
+bool SkipFrame(Cursor& cursor) {
+    const FrameHeader* frame = cursor.take<FrameHeader>();
+    if (!frame || frame->magic != FRAME_MAGIC) {
+        return false;
+    }
+    for (uint32_t n = 0; n < frame->n_cmd_lists; n++) {
+        const ListHeader* list = cursor.take<ListHeader>();
+        if (!list || !cursor.take<CmdRecord>(list->n_cmds) ||
+            !cursor.take<ImDrawVert>(list->n_vtxs) ||
+            !cursor.take<ImDrawIdx>(list->n_idxs)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// -------------------------------- Interfaces ---------------------------------
+// -----------------------------------------------------------------------------
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_BeginCapture(const char* filename) {
+    ImGui_ImplVulkanHpp_EndCapture();
+
+    g_capture.fp = std::fopen(filename, "wb");
+    if (!g_capture.fp) {
+        return false;
+    }
+    const FileHeader header = {FILE_MAGIC, FILE_VERSION, sizeof(ImDrawVert),
+                               sizeof(ImDrawIdx)};
+    if (!WritePadded(g_capture.fp, &header, sizeof(header))) {
+        ImGui_ImplVulkanHpp_EndCapture();
+        return false;
+    }
+    return true;
+}
+
+IMGUI_IMPL_API bool ImGui_ImplVulkanHpp_CaptureFrame(
+        const ImDrawData* draw_data) {
+    FILE* fp = g_capture.fp;
+    if (!fp || !draw_data) {
+        return false;
+    }
+
+    FrameHeader frame = {};
+    frame.magic = FRAME_MAGIC;
+    frame.n_cmd_lists = static_cast<uint32_t>(draw_data->CmdListsCount);
+    frame.total_vtx_count = static_cast<uint32_t>(draw_data->TotalVtxCount);
+    frame.total_idx_count = static_cast<uint32_t>(draw_data->TotalIdxCount);
+    frame.display_pos[0] = draw_data->DisplayPos.x;
+    frame.display_pos[1] = draw_data->DisplayPos.y;
+    frame.display_size[0] = draw_data->DisplaySize.x;
+    frame.display_size[1] = draw_data->DisplaySize.y;
+    frame.framebuffer_scale[0] = draw_data->FramebufferScale.x;
+    frame.framebuffer_scale[1] = draw_data->FramebufferScale.y;
+    bool ret = WritePadded(fp, &frame, sizeof(frame));
+
+    auto& cmd_records = g_capture.cmd_records;
+    for (int n = 0; ret && n < draw_data->CmdListsCount; n++) {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+
+        // Convert commands into the fixed layout
+        cmd_records.clear();
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++) {
+            const ImDrawCmd& cmd = cmd_list->CmdBuffer[cmd_i];
+            CmdRecord rec = {};
+            rec.clip_rect[0] = cmd.ClipRect.x;
+            rec.clip_rect[1] = cmd.ClipRect.y;
+            rec.clip_rect[2] = cmd.ClipRect.z;
+            rec.clip_rect[3] = cmd.ClipRect.w;
+            rec.tex_id = static_cast<uint64_t>(
+                    reinterpret_cast<uintptr_t>(cmd.TextureId));
+            rec.vtx_offset = cmd.VtxOffset;
+            rec.idx_offset = cmd.IdxOffset;
+            rec.elem_count = cmd.ElemCount;
+            if (cmd.UserCallback == ImDrawCallback_ResetRenderState) {
+                rec.flags = CMD_FLAG_RESET_RENDER_STATE;
+            } else if (cmd.UserCallback != nullptr) {
+                rec.flags = CMD_FLAG_USER_CALLBACK;
+            }
+            cmd_records.push_back(rec);
+        }
+
+        ListHeader list = {};
+        list.n_cmds = static_cast<uint32_t>(cmd_records.size());
+        list.n_vtxs = static_cast<uint32_t>(cmd_list->VtxBuffer.Size);
+        list.n_idxs = static_cast<uint32_t>(cmd_list->IdxBuffer.Size);
+        ret = WritePadded(fp, &list, sizeof(list)) &&
+              WritePadded(fp, cmd_records.data(),
+                          cmd_records.size() * sizeof(CmdRecord)) &&
+              WritePadded(fp, cmd_list->VtxBuffer.Data,
+                          list.n_vtxs * sizeof(ImDrawVert)) &&
+              WritePadded(fp, cmd_list->IdxBuffer.Data,
+                          list.n_idxs * sizeof(ImDrawIdx));
+    }
+    return ret;
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_EndCapture() {
+    if (g_capture.fp) {
+        std::fclose(g_capture.fp);
+    }
+    g_capture = {};
+}
+
+IMGUI_IMPL_API ImGui_ImplVulkanHpp_Replay* ImGui_ImplVulkanHpp_OpenReplay(
+        const char* filename) {
+    std::unique_ptr<ImGui_ImplVulkanHpp_Replay> replay(
+            new ImGui_ImplVulkanHpp_Replay);
+    if (!replay->file.open(filename)) {
+        return nullptr;
+    }
+
+    // Check header
+    Cursor cursor(replay->file.data(), replay->file.size());
+    const FileHeader* header = cursor.take<FileHeader>();
+    if (!header || header->magic != FILE_MAGIC ||
+        header->version != FILE_VERSION ||
+        header->vtx_stride != sizeof(ImDrawVert) ||
+        header->idx_stride != sizeof(ImDrawIdx)) {
+        return nullptr;  // Incompatible capture
+    }
+
+    // Index frames (Truncated last frame is ignored)
+    while (!cursor.empty()) {
+        const size_t offset = cursor.pos();
+        if (!SkipFrame(cursor)) {
+            break;
+        }
+        replay->frame_offsets.push_back(offset);
+    }
+    return replay.release();
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_CloseReplay(
+        ImGui_ImplVulkanHpp_Replay* replay) {
+    delete replay;
+}
+
+IMGUI_IMPL_API int ImGui_ImplVulkanHpp_GetReplayFrameCount(
+        const ImGui_ImplVulkanHpp_Replay* replay) {
+    return replay ? static_cast<int>(replay->frame_offsets.size()) : 0;
+}
+
+IMGUI_IMPL_API ImDrawData* ImGui_ImplVulkanHpp_GetReplayFrame(
+        ImGui_ImplVulkanHpp_Replay* replay, int frame_idx, ImTextureID tex_id) {
+    if (!replay || frame_idx < 0 ||
+        replay->frame_offsets.size() <= static_cast<size_t>(frame_idx)) {
+        return nullptr;
+    }
+
+    Cursor cursor(replay->file.data(), replay->file.size());
+    cursor.seek(replay->frame_offsets[static_cast<size_t>(frame_idx)]);
+    const FrameHeader* frame = cursor.take<FrameHeader>();
+
+    // Prepare draw lists
+    auto& draw_lists = replay->draw_lists;
+    while (draw_lists.size() < frame->n_cmd_lists) {
+        draw_lists.emplace_back(new ImDrawList(nullptr));
+    }
+    replay->draw_list_ptrs.clear();
+
+    for (uint32_t n = 0; n < frame->n_cmd_lists; n++) {
+        ImDrawList* draw_list = draw_lists[n].get();
+        const ListHeader* list = cursor.take<ListHeader>();
+        const CmdRecord* recs = cursor.take<CmdRecord>(list->n_cmds);
+
+        // Commands
+        draw_list->CmdBuffer.resize(0);
+        for (uint32_t cmd_i = 0; cmd_i < list->n_cmds; cmd_i++) {
+            const CmdRecord& rec = recs[cmd_i];
+            if (rec.flags == CMD_FLAG_USER_CALLBACK) {
+                continue;  // Unable to replay
+            }
+            ImDrawCmd cmd;
+            cmd.ClipRect = {rec.clip_rect[0], rec.clip_rect[1],
+                            rec.clip_rect[2], rec.clip_rect[3]};
+            cmd.TextureId = tex_id;
+            cmd.VtxOffset = rec.vtx_offset;
+            cmd.IdxOffset = rec.idx_offset;
+            cmd.ElemCount = rec.elem_count;
+            if (rec.flags == CMD_FLAG_RESET_RENDER_STATE) {
+                cmd.UserCallback = ImDrawCallback_ResetRenderState;
+            }
+            draw_list->CmdBuffer.push_back(cmd);
+        }
+
+        // Vertices and indices (Zero copy)
+        const ImDrawVert* vtxs = cursor.take<ImDrawVert>(list->n_vtxs);
+        const ImDrawIdx* idxs = cursor.take<ImDrawIdx>(list->n_idxs);
+        BorrowVector(draw_list->VtxBuffer, vtxs, list->n_vtxs);
+        BorrowVector(draw_list->IdxBuffer, idxs, list->n_idxs);
+        replay->draw_list_ptrs.push_back(draw_list);
+    }
+
+    // Draw data
+    ImDrawData& draw_data = replay->draw_data;
+    draw_data.Clear();
+    draw_data.Valid = true;
+    draw_data.CmdLists = replay->draw_list_ptrs.data();
+    draw_data.CmdListsCount = static_cast<int>(frame->n_cmd_lists);
+    draw_data.TotalVtxCount = static_cast<int>(frame->total_vtx_count);
+    draw_data.TotalIdxCount = static_cast<int>(frame->total_idx_count);
+    draw_data.DisplayPos = {frame->display_pos[0], frame->display_pos[1]};
+    draw_data.DisplaySize = {frame->display_size[0], frame->display_size[1]};
+    draw_data.FramebufferScale = {frame->framebuffer_scale[0],
+                                  frame->framebuffer_scale[1]};
+    return &draw_data;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+#include <vkw/vkw.h>
+
+BEGIN_VKW_SUPPRESS_WARNING
+#include "imgui_impl_vulkanhpp.h"
+#include "imgui_impl_vulkanhpp_pacer.h"
+END_VKW_SUPPRESS_WARNING
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// -------------------------------- Frame Slot ---------------------------------
+// -----------------------------------------------------------------------------
+struct FrameSlot {
+    vkw::CommandBuffersPackPtr cmd_bufs_pack;  // Own pool for each slot
+    std::vector<vk::UniqueSemaphore> semaphores;
+    std::vector<vk::Semaphore> raw_semaphores;
+    vk::UniqueFence fence;
+    bool is_pending = false;  // Submitted, and not waited yet
+    uint64_t frame_idx = 0;   // Backend frame recorded with this slot
+};
+
+// Returns blocked time [us]
+float WaitSlot(const vk::Device& device, FrameSlot& slot) {
+    if (!slot.is_pending) {
+        return 0.f;
+    }
+    const auto wait_start = std::chrono::steady_clock::now();
+    const auto ret =
+            device.waitForFences(slot.fence.get(), VK_TRUE, UINT64_MAX);
+    if (ret != vk::Result::eSuccess) {
+        throw std::runtime_error("Failed to wait for frame fence");
+    }
+    device.resetFences(slot.fence.get());
+    slot.is_pending = false;
+    const auto wait_end = std::chrono::steady_clock::now();
+    return std::chrono::duration<float, std::micro>(wait_end - wait_start)
+            .count();
+}
+
+}  // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// ------------------------------- Pacer Context -------------------------------
+// -----------------------------------------------------------------------------
+struct ImGui_ImplVulkanHpp_FramePacer {
+    vk::Device device;
+    std::vector<FrameSlot> slots;
+    size_t slot_idx = 0;  // Slot of the current frame
+    ImGui_ImplVulkanHpp_PacedFrame frame;
+};
+
+// -----------------------------------------------------------------------------
+// -------------------------------- Interfaces ---------------------------------
+// -----------------------------------------------------------------------------
+IMGUI_IMPL_API ImGui_ImplVulkanHpp_FramePacer*
+ImGui_ImplVulkanHpp_CreateFramePacer(
+        const vk::UniqueDevice& device,
+        const ImGui_ImplVulkanHpp_FramePacerDesc& desc) {
+    auto pacer = new ImGui_ImplVulkanHpp_FramePacer;
+    pacer->device = device.get();
+    pacer->slots.resize(std::max(desc.n_frames_in_flight, 1u));
+    for (auto&& slot : pacer->slots) {
+        slot.cmd_bufs_pack = vkw::CreateCommandBuffersPack(
+                device, desc.queue_family_idx, desc.n_cmd_bufs);
+        for (uint32_t i = 0; i < desc.n_semaphores; i++) {
+            slot.semaphores.push_back(device->createSemaphoreUnique({}));
+            slot.raw_semaphores.push_back(slot.semaphores.back().get());
+        }
+        slot.fence = device->createFenceUnique({});
+    }
+    return pacer;
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_DestroyFramePacer(
+        ImGui_ImplVulkanHpp_FramePacer* pacer) {
+    if (!pacer) {
+        return;
+    }
+    ImGui_ImplVulkanHpp_WaitPacedFramesIdle(pacer);
+    delete pacer;
+}
+
+IMGUI_IMPL_API const ImGui_ImplVulkanHpp_PacedFrame&
+ImGui_ImplVulkanHpp_BeginPacedFrame(ImGui_ImplVulkanHpp_FramePacer* pacer) {
+    auto& slot = pacer->slots[pacer->slot_idx];
+    const float wait_us = WaitSlot(pacer->device, slot);
+
+    // Always reported, so that the backend never assumes that the previous
+    // frame is completed. (Zero for the first use of the slot)
+    ImGui_ImplVulkanHpp_SetCompletedFrameIndex(slot.frame_idx);
+
+    auto& frame = pacer->frame;
+    frame.slot_idx = static_cast<uint32_t>(pacer->slot_idx);
+    frame.cmd_bufs = slot.cmd_bufs_pack->cmd_bufs.data();
+    frame.semaphores = slot.raw_semaphores.data();
+    frame.fence = slot.fence.get();
+    frame.wait_us = wait_us;
+    return frame;
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_EndPacedFrame(
+        ImGui_ImplVulkanHpp_FramePacer* pacer) {
+    auto& slot = pacer->slots[pacer->slot_idx];
+    slot.is_pending = true;
+    slot.frame_idx = ImGui_ImplVulkanHpp_GetFrameIndex();
+    pacer->slot_idx = (pacer->slot_idx + 1) % pacer->slots.size();
+}
+
+IMGUI_IMPL_API void ImGui_ImplVulkanHpp_WaitPacedFramesIdle(
+        ImGui_ImplVulkanHpp_FramePacer* pacer) {
+    uint64_t completed_frame_idx = 0;
+    for (auto&& slot : pacer->slots) {
+        WaitSlot(pacer->device, slot);
+        completed_frame_idx = std::max(completed_frame_idx, slot.frame_idx);
+    }
+    ImGui_ImplVulkanHpp_SetCompletedFrameIndex(completed_frame_idx);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------